@@ -0,0 +1,289 @@
+// DdaBenchmark.cpp
+// Ray marching microbenchmark: traces random ray packets through large random
+// maps and reports DDA cell steps per second for the scalar and packet paths.
+#include "RayTraversal.hpp"
+#include "Map.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int packetSize = 8;
+
+struct Options {
+    int packetCount = 20000;
+    int repeats = 5;
+    float density = 0.02f;    // Fraction of interior cells that are walls
+    bool verify = false;
+};
+
+// One origin with 8 neighbouring directions, like adjacent screen columns
+struct RayPacket {
+    sf::Vector2f origin;
+    sf::Vector2f directions[packetSize];
+};
+
+void scatterWalls(Map& map, float density, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    std::uniform_int_distribution<int> wallType(1, 5);
+    for (int y = 1; y < map.getHeight() - 1; y++) {
+        for (int x = 1; x < map.getWidth() - 1; x++) {
+            if (chance(rng) < density && !map.isTarget(x, y)) {
+                map.setValueAt(x, y, wallType(rng));
+            }
+        }
+    }
+}
+
+std::vector<RayPacket> makePackets(const Map& map, int count, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> cellX(1, map.getWidth() - 2);
+    std::uniform_int_distribution<int> cellY(1, map.getHeight() - 2);
+    std::uniform_real_distribution<float> offset(0.05f, 0.95f);
+    std::uniform_real_distribution<float> heading(0.0f, 6.2831853f);
+
+    std::vector<RayPacket> packets;
+    packets.reserve(count);
+    while (static_cast<int>(packets.size()) < count) {
+        int x = cellX(rng), y = cellY(rng);
+        if (map.isWall(x, y)) continue;
+
+        RayPacket packet;
+        packet.origin = sf::Vector2f(x + offset(rng), y + offset(rng));
+        float angle = heading(rng);
+        for (int lane = 0; lane < packetSize; lane++) {
+            float a = angle + lane * 0.002f;
+            packet.directions[lane] = sf::Vector2f(std::cos(a), std::sin(a));
+        }
+        packets.push_back(packet);
+    }
+    return packets;
+}
+
+// Each DDA step moves exactly one cell along x or y
+long long countSteps(const RayPacket& packet, const RayHit* hits)
+{
+    int originX = static_cast<int>(packet.origin.x);
+    int originY = static_cast<int>(packet.origin.y);
+    long long steps = 0;
+    for (int lane = 0; lane < packetSize; lane++) {
+        steps += std::abs(hits[lane].mapX - originX) + std::abs(hits[lane].mapY - originY);
+    }
+    return steps;
+}
+
+void tracePacket(int width, const RayPacket& packet, const Map& map, RayHit* hits)
+{
+    switch (width) {
+        case 8:
+            traceRayPacket8(packet.origin, packet.directions, map, hits);
+            break;
+        case 4:
+            traceRayPacket4(packet.origin, packet.directions, map, hits);
+            traceRayPacket4(packet.origin, packet.directions + 4, map, hits + 4);
+            break;
+        default:
+            for (int lane = 0; lane < packetSize; lane++) {
+                hits[lane] = traceRay(packet.origin, packet.directions[lane], map);
+            }
+            break;
+    }
+}
+
+// The plain one-cell-at-a-time DDA, without empty-space skipping: every
+// trace path must reproduce it exactly
+RayHit referenceTrace(const sf::Vector2f& origin, const sf::Vector2f& rayDir, const Map& map)
+{
+    RayHit hit{};
+    int mapX = static_cast<int>(origin.x);
+    int mapY = static_cast<int>(origin.y);
+    float deltaX = std::abs(1 / rayDir.x);
+    float deltaY = std::abs(1 / rayDir.y);
+    int stepX = rayDir.x < 0 ? -1 : 1;
+    int stepY = rayDir.y < 0 ? -1 : 1;
+    float sideX = (rayDir.x < 0 ? origin.x - mapX : mapX + 1.0f - origin.x) * deltaX;
+    float sideY = (rayDir.y < 0 ? origin.y - mapY : mapY + 1.0f - origin.y) * deltaY;
+
+    while (true) {
+        int side;
+        if (sideX < sideY) {
+            sideX += deltaX;
+            mapX += stepX;
+            side = 0;
+        } else {
+            sideY += deltaY;
+            mapY += stepY;
+            side = 1;
+        }
+
+        int wallType = map.getWallTypeUnchecked(mapX, mapY);
+        if (wallType > 0) {
+            hit.mapX = mapX;
+            hit.mapY = mapY;
+            hit.side = side;
+            hit.wallType = wallType;
+            hit.distance = side == 0 ? (mapX - origin.x + (1 - stepX) / 2) / rayDir.x
+                                     : (mapY - origin.y + (1 - stepY) / 2) / rayDir.y;
+            return hit;
+        }
+    }
+}
+
+bool sameHit(const RayHit& a, const RayHit& b)
+{
+    return a.mapX == b.mapX && a.mapY == b.mapY && a.side == b.side &&
+           a.wallType == b.wallType && a.distance == b.distance;
+}
+
+// Hits at every packet width, empty-space skipping included, must be
+// identical to the plain DDA
+bool verifyPackets(const std::vector<RayPacket>& packets, const Map& map, int width)
+{
+    RayHit expected[packetSize], actual[packetSize];
+    for (size_t i = 0; i < packets.size(); i++) {
+        for (int lane = 0; lane < packetSize; lane++) {
+            expected[lane] = referenceTrace(packets[i].origin, packets[i].directions[lane], map);
+        }
+        tracePacket(width, packets[i], map, actual);
+        for (int lane = 0; lane < packetSize; lane++) {
+            if (!sameHit(expected[lane], actual[lane])) {
+                std::cerr << map.getWidth() << "x" << map.getHeight() << ": packet " << i
+                          << " lane " << lane << " differs from the plain DDA at width " << width << std::endl;
+                return false;
+            }
+        }
+    }
+    std::cout << map.getWidth() << "x" << map.getHeight() << ": packet width " << width
+              << " matches the plain DDA on " << packets.size() * packetSize << " rays" << std::endl;
+    return true;
+}
+
+// Random wall and target edits, so verification also covers the occupancy
+// pyramid's incremental updates, not just the one built with the map, and
+// checks that target edits leave empty-space skipping alone
+void editMap(Map& map, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> cellX(1, map.getWidth() - 2);
+    std::uniform_int_distribution<int> cellY(1, map.getHeight() - 2);
+    std::uniform_int_distribution<int> wallType(0, 5);
+    for (int i = 0; i < 2000; i++) {
+        int x = cellX(rng), y = cellY(rng);
+        switch (i % 4) {
+            case 0: map.setValueAt(x, y, wallType(rng)); break;
+            case 1: map.setValueAt(x, y, 0); break;
+            case 2: map.addTarget(x, y); break;
+            default: map.removeTarget(map.getTargets().empty() ? x : map.getTargets().front().x,
+                                      map.getTargets().empty() ? y : map.getTargets().front().y); break;
+        }
+    }
+}
+
+void runWidth(const std::vector<RayPacket>& packets, const Map& map, int width, const Options& options)
+{
+    RayHit hits[packetSize];
+    long long steps = 0;
+    for (const RayPacket& packet : packets) {
+        tracePacket(width, packet, map, hits);
+        steps += countSteps(packet, hits);
+    }
+
+    // Best of several passes, to keep scheduler noise out of the numbers
+    double bestSeconds = 0.0;
+    for (int repeat = 0; repeat < options.repeats; repeat++) {
+        auto start = std::chrono::steady_clock::now();
+        for (const RayPacket& packet : packets) {
+            tracePacket(width, packet, map, hits);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (repeat == 0 || seconds < bestSeconds) bestSeconds = seconds;
+    }
+
+    double rays = static_cast<double>(packets.size()) * packetSize;
+    std::cout << std::fixed << std::setprecision(1)
+              << std::left << std::setw(10) << (std::to_string(map.getWidth()) + "x" + std::to_string(map.getHeight()))
+              << " packet=" << width
+              << " rays=" << static_cast<long long>(rays)
+              << " steps/ray=" << steps / rays
+              << " " << steps / bestSeconds / 1.0e6 << " Msteps/s"
+              << std::setprecision(2)
+              << " " << bestSeconds * 1.0e9 / rays << " ns/ray"
+              << std::endl;
+}
+
+void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [--size N] [--packets N] [--repeats N] [--density F] [--verify]" << std::endl
+              << "Without --size, runs 20x20, 256x256, 1024x1024 and 4096x4096 maps." << std::endl
+              << "--packets sets how many 8-ray packets are traced per pass (default 20000)." << std::endl
+              << "--density sets the fraction of random wall cells (default 0.02)." << std::endl
+              << "--verify checks every path against the plain DDA, before and after random edits, instead of timing." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    std::vector<int> sizes = {20, 256, 1024, 4096};
+    std::vector<int> customSizes;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            int size = std::atoi(argv[++i]);
+            if (size < 20) {
+                std::cerr << "Invalid map size (minimum 20): " << argv[i] << std::endl;
+                return 1;
+            }
+            customSizes.push_back(size);
+        } else if (arg == "--packets" && i + 1 < argc) {
+            options.packetCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            options.repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--density" && i + 1 < argc) {
+            options.density = std::min(0.9f, std::max(0.0f, static_cast<float>(std::atof(argv[++i]))));
+        } else if (arg == "--verify") {
+            options.verify = true;
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (!customSizes.empty()) sizes = customSizes;
+
+    std::vector<int> widths = {1};
+    if (getMaxPacketWidth() >= 4) widths.push_back(4);
+    if (getMaxPacketWidth() >= 8) widths.push_back(8);
+
+    for (int size : sizes) {
+        std::mt19937 rng(size);
+        Map map(size, size);
+        scatterWalls(map, options.density, rng);
+        std::vector<RayPacket> packets = makePackets(map, options.packetCount, rng);
+
+        if (options.verify) {
+            for (int pass = 0; pass < 2; pass++) {
+                for (int width : widths) {
+                    if (!verifyPackets(packets, map, width)) return 1;
+                }
+                editMap(map, rng);
+            }
+            continue;
+        }
+        for (int width : widths) {
+            runWidth(packets, map, width, options);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,579 @@
+// FrameBenchmark.cpp
+// Headless frame benchmark: replays a scripted camera path through the default
+// Map and reports per-frame latency percentiles and MPixels/s for castRays.
+#include "RayCaster.hpp"
+#include "Player.hpp"
+#include "Map.hpp"
+#include "SpanShader.hpp"
+#include "Profiler.hpp"
+#include "ResolutionController.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Resolution {
+    int width;
+    int height;
+    const char* name;
+};
+
+struct Pose {
+    sf::Vector2f position;
+    sf::Vector2f direction;
+    sf::Vector2f plane;
+};
+
+// Closed loop through the open corridors of the default 20x20 map
+const sf::Vector2f cameraPath[] = {
+    {3.5f, 3.5f}, {16.5f, 3.5f}, {16.5f, 16.5f}, {3.5f, 16.5f}
+};
+const int cameraPathLength = sizeof(cameraPath) / sizeof(cameraPath[0]);
+
+// Deterministic pose for frame i of n: walk the loop while sweeping the view
+Pose poseAt(int frame, int frameCount)
+{
+    float t = static_cast<float>(frame) / frameCount * cameraPathLength;
+    int segment = static_cast<int>(t) % cameraPathLength;
+    float along = t - std::floor(t);
+
+    const sf::Vector2f& a = cameraPath[segment];
+    const sf::Vector2f& b = cameraPath[(segment + 1) % cameraPathLength];
+
+    Pose pose;
+    pose.position = sf::Vector2f(a.x + (b.x - a.x) * along, a.y + (b.y - a.y) * along);
+
+    // Look along the segment, swaying +-45 degrees so we see both near walls and long corridors
+    float heading = std::atan2(b.y - a.y, b.x - a.x) + 0.785f * std::sin(frame * 0.05f);
+    pose.direction = sf::Vector2f(std::cos(heading), std::sin(heading));
+    pose.plane = sf::Vector2f(-pose.direction.y * 0.66f, pose.direction.x * 0.66f);
+    return pose;
+}
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+struct Options {
+    int frameCount = 200;
+    int warmupFrames = 10;
+    unsigned threadCount = 0;
+    bool columnMajor = false;
+    int packetWidth = 0;       // 0 = widest the CPU supports
+    bool dash = false;
+    bool idle = false;
+    bool flat = false;         // Untextured walls
+    bool interlace = false;    // Trace alternate columns, estimate the rest
+    double minFps = 0.0;       // Fail when any resolution's mean frame rate is lower
+    bool verify = false;
+    bool stages = false;       // Print mean top-level stage times (profiling builds)
+    double budgetMs = 0.0;     // Dynamic resolution frame budget; 0 = fixed resolution
+    std::string tracePath;
+    std::string csvPath;
+};
+
+// With --idle the camera rests on each pose for idleFrames frames, the way an
+// unattended kiosk sits still, so most frames only redraw the animated colors
+const int idleFrames = 50;
+
+Pose framePose(int frame, const Options& options)
+{
+    return poseAt(options.idle ? frame / idleFrames * idleFrames : frame, options.frameCount);
+}
+
+// Trace and shade one frame. With --dash the frames run through repeated
+// dash cycles: 19 dash frames, then one normal frame that restarts the effect.
+void renderFrame(RayCaster& raycaster, FrameState& state, const Player& player, const Map& map,
+                 int frame, const Options& options)
+{
+    raycaster.traceFrame(player, map, state);
+    state.dashing = options.dash && frame % 20 != 19;
+
+    // Dash particles are placed with rand(); reseed so every renderer sees the same ones
+    std::srand(static_cast<unsigned>(frame));
+    raycaster.renderFrame(state, player, map);
+}
+
+const char* layoutName(bool columnMajor)
+{
+    return columnMajor ? "column" : "row";
+}
+
+// Render the whole path with the serial row-major reference and with the
+// configured threads/layout; frames must match bit for bit
+bool verifyDeterminism(const Resolution& res, const Options& options)
+{
+    Map map;
+    Player player;
+    FrameState serialState, parallelState;
+    RayCaster serial(res.width, res.height, true);
+    RayCaster parallel(res.width, res.height, true);
+    serial.setThreadCount(1);
+    serial.setPacketWidth(1);
+    serial.setIncremental(false);
+    serial.setTexturedWalls(!options.flat);
+    parallel.setTexturedWalls(!options.flat);
+    parallel.setThreadCount(options.threadCount);
+    parallel.setColumnMajor(options.columnMajor);
+    serial.setInterlaced(options.interlace);
+    parallel.setInterlaced(options.interlace);
+    if (options.packetWidth > 0) parallel.setPacketWidth(options.packetWidth);
+
+    size_t frameBytes = static_cast<size_t>(res.width) * res.height * 4;
+    for (int i = 0; i < options.frameCount; i++) {
+        Pose pose = framePose(i, options);
+        player.setPose(pose.position, pose.direction, pose.plane);
+        renderFrame(serial, serialState, player, map, i, options);
+        renderFrame(parallel, parallelState, player, map, i, options);
+
+        if (std::memcmp(serial.getFrameBuffer().bytes(),
+                        parallel.getFrameBuffer().bytes(), frameBytes) != 0) {
+            std::cerr << res.name << ": frame " << i << " differs from the reference with "
+                      << parallel.getThreadCount() << " threads, " << layoutName(options.columnMajor)
+                      << "-major layout, packet width " << parallel.getPacketWidth() << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << res.name << ": " << options.frameCount << " frames identical to the reference with "
+              << parallel.getThreadCount() << " threads, " << layoutName(options.columnMajor)
+              << "-major layout, packet width " << parallel.getPacketWidth() << std::endl;
+    return true;
+}
+
+// How close interlaced estimates come to tracing every column: hits of the
+// estimated columns against a full trace of the same pose. Once the camera
+// rests (--idle) the hits must match exactly.
+bool measureInterlace(const Resolution& res, const Options& options)
+{
+    Map map;
+    Player player;
+    FrameState fullState, interlacedState;
+    RayCaster full(res.width, res.height, true);
+    RayCaster interlaced(res.width, res.height, true);
+    interlaced.setInterlaced(true);
+
+    long long estimated = 0, sameFace = 0, staleFrames = 0;
+    double depthError = 0.0;
+    for (int i = 0; i < options.frameCount; i++) {
+        Pose pose = framePose(i, options);
+        player.setPose(pose.position, pose.direction, pose.plane);
+        full.traceFrame(player, map, fullState);
+        interlaced.traceFrame(player, map, interlacedState);
+
+        const HitBuffer& expected = fullState.columnHits;
+        const HitBuffer& actual = interlacedState.columnHits;
+        bool exact = true;
+        for (int x = 0; x < expected.size(); x++) {
+            bool face = expected.mapX[x] == actual.mapX[x] && expected.mapY[x] == actual.mapY[x] &&
+                        expected.side[x] == actual.side[x];
+            exact = exact && face && expected.distance[x] == actual.distance[x];
+            if (!interlacedState.reconstructed || (x & 1) == interlacedState.tracedParity) continue;
+
+            estimated++;
+            if (face) sameFace++;
+            depthError += std::abs(actual.distance[x] - expected.distance[x]) / expected.distance[x];
+        }
+
+        // A resting camera gets one frame to trace the estimated half
+        bool resting = i > 0 && framePose(i - 1, options).position == pose.position &&
+                       framePose(i - 1, options).direction == pose.direction;
+        bool settled = resting && i > 1 && framePose(i - 2, options).position == pose.position &&
+                       framePose(i - 2, options).direction == pose.direction;
+        if (settled && !exact) staleFrames++;
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << res.name << ": interlaced, " << estimated
+              << " estimated columns, " << (estimated ? 100.0 * sameFace / estimated : 100.0)
+              << "% on the traced wall face, mean depth error "
+              << (estimated ? 100.0 * depthError / estimated : 0.0) << "%" << std::endl;
+    if (staleFrames > 0) {
+        std::cerr << res.name << ": " << staleFrames << " frames still differ from a full trace after the camera stopped"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Change the render resolution while the path plays: each frame must match a
+// reference renderer built at that size, so nothing stale survives a resize
+bool verifyRenderResolution(const Resolution& res, const Options& options)
+{
+    const int scalePercents[] = {100, 75, 50};
+    const int scaleCount = 3;
+    const int framesPerScale = 10;
+
+    Map map;
+    Player player;
+    FrameState scaledState;
+    FrameState referenceStates[scaleCount];
+    std::vector<std::unique_ptr<RayCaster>> references;
+    for (int percent : scalePercents) {
+        references.push_back(std::make_unique<RayCaster>(res.width * percent / 100, res.height * percent / 100, true));
+        references.back()->setThreadCount(1);
+        references.back()->setPacketWidth(1);
+        references.back()->setIncremental(false);
+        references.back()->setTexturedWalls(!options.flat);
+    }
+
+    RayCaster scaled(res.width, res.height, true);
+    scaled.setTexturedWalls(!options.flat);
+    scaled.setThreadCount(options.threadCount);
+    scaled.setColumnMajor(options.columnMajor);
+    if (options.packetWidth > 0) scaled.setPacketWidth(options.packetWidth);
+
+    for (int i = 0; i < options.frameCount; i++) {
+        // 100%, 75%, 50%, 75%, 100%, ...
+        int step = i / framesPerScale % (2 * scaleCount - 2);
+        int s = step < scaleCount ? step : 2 * scaleCount - 2 - step;
+        const RayCaster& reference = *references[s];
+        scaled.setRenderResolution(reference.getRenderWidth(), reference.getRenderHeight());
+
+        // Every reference draws every frame, so the animations stay in step
+        Pose pose = framePose(i, options);
+        player.setPose(pose.position, pose.direction, pose.plane);
+        for (int r = 0; r < scaleCount; r++) {
+            renderFrame(*references[r], referenceStates[r], player, map, i, options);
+        }
+        renderFrame(scaled, scaledState, player, map, i, options);
+
+        size_t frameBytes = reference.getFrameBuffer().getPixelCount() * 4;
+        if (std::memcmp(reference.getFrameBuffer().bytes(), scaled.getFrameBuffer().bytes(), frameBytes) != 0) {
+            std::cerr << res.name << ": frame " << i << " at " << scalePercents[s]
+                      << "% differs from a renderer built at that size" << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << res.name << ": " << options.frameCount << " frames identical across render resolution changes"
+              << std::endl;
+    return true;
+}
+
+// Every SIMD span kernel must match the scalar reference bit for bit
+bool verifySpanShaders()
+{
+    const SpanShaderLevel levels[] = {SpanShaderLevel::SSE42, SpanShaderLevel::AVX2};
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> coord(0, 2160);
+    std::uniform_int_distribution<std::uint32_t> colorBits;
+
+    std::vector<Pixel> expected(4096 * 2), actual(4096 * 2);
+    std::vector<Pixel> texels(64);
+    std::vector<int> rowStarts(4096 * 2);
+    for (Pixel& texel : texels) texel = colorBits(rng);
+    bool ok = true;
+
+    for (SpanShaderLevel level : levels) {
+        if (!isSpanShaderLevelSupported(level)) {
+            std::cout << "span shader " << getSpanShaderLevelName(level) << ": not supported, skipped" << std::endl;
+            continue;
+        }
+
+        int mismatches = 0;
+        for (int trial = 0; trial < 20000 && mismatches == 0; trial++) {
+            int a = coord(rng), b = coord(rng);
+            int spanStart = std::min(a, b);
+            int spanEnd = std::max(a, b) + 1;
+            Pixel color = colorBits(rng);
+            bool wall = trial % 2 == 0;
+            SpanProfile profile = makeSpanProfile(spanStart, spanEnd, wall ? 1.3f : 1.0f, wall ? 0.3f : 4.0f);
+            std::ptrdiff_t stride = trial % 3 == 0 ? 2 : 1;
+
+            size_t count = static_cast<size_t>(spanEnd - spanStart) * stride;
+            std::fill(expected.begin(), expected.begin() + count, 0u);
+            std::fill(actual.begin(), actual.begin() + count, 0u);
+            if (trial % 8 == 7) {
+                // Grid row over a random coverage mask; spanStart doubles as the row
+                int du = static_cast<int>(colorBits(rng) % 0x40000) - 0x20000;
+                int dv = static_cast<int>(colorBits(rng) % 0x40000) - 0x20000;
+                int u = static_cast<int>(colorBits(rng)), v = static_cast<int>(colorBits(rng));
+                int lineWidth = static_cast<int>(colorBits(rng) % 0x8000);
+                int rowCount = static_cast<int>(count);
+                for (int i = 0; i < rowCount; i++) rowStarts[i] = coord(rng);
+                shadeGridRowScalar(expected.data(), rowCount, rowStarts.data(), spanStart, u, v, du, dv,
+                                   lineWidth, color, ~color);
+                shadeGridRowWithLevel(level, actual.data(), rowCount, rowStarts.data(), spanStart, u, v, du, dv,
+                                      lineWidth, color, ~color);
+            } else if (trial % 4 < 2) {
+                shadeSpanScalar(expected.data(), stride, spanStart, spanEnd, color, profile);
+                shadeSpanWithLevel(level, actual.data(), stride, spanStart, spanEnd, color, profile);
+            } else {
+                // Map the span onto the whole texel strip, as a wall slice does
+                int vStep = (static_cast<int>(texels.size()) << 16) / (spanEnd - spanStart);
+                shadeTexturedSpanScalar(expected.data(), stride, spanStart, spanEnd, texels.data(), 0, vStep, profile);
+                shadeTexturedSpanWithLevel(level, actual.data(), stride, spanStart, spanEnd, texels.data(), 0, vStep, profile);
+            }
+
+            if (!std::equal(expected.begin(), expected.begin() + count, actual.begin())) {
+                std::cerr << "span shader " << getSpanShaderLevelName(level) << ": mismatch for span ["
+                          << spanStart << ", " << spanEnd << ") stride " << stride << std::endl;
+                mismatches++;
+                ok = false;
+            }
+        }
+
+        if (mismatches == 0) {
+            std::cout << "span shader " << getSpanShaderLevelName(level) << ": matches scalar reference" << std::endl;
+        }
+    }
+    return ok;
+}
+
+// Returns the mean frames per second
+double runResolution(const Resolution& res, const Options& options)
+{
+    int frameCount = options.frameCount;
+    Map map;
+    Player player;
+    FrameState state;
+    RayCaster raycaster(res.width, res.height, true);
+    raycaster.setThreadCount(options.threadCount);
+    raycaster.setColumnMajor(options.columnMajor);
+    raycaster.setTexturedWalls(!options.flat);
+    raycaster.setInterlaced(options.interlace);
+    if (options.packetWidth > 0) raycaster.setPacketWidth(options.packetWidth);
+
+    for (int i = 0; i < options.warmupFrames; i++) {
+        Pose pose = framePose(i, options);
+        player.setPose(pose.position, pose.direction, pose.plane);
+        renderFrame(raycaster, state, player, map, i, options);
+    }
+
+    std::vector<double> frameMs;
+    frameMs.reserve(frameCount);
+    double stageMs[profileStageCount] = {};
+    double pixels = 0.0;
+
+    ResolutionController::Settings budget;
+    budget.targetFrameTime = static_cast<float>(options.budgetMs / 1000.0);
+    ResolutionController controller(budget);
+
+    for (int i = 0; i < frameCount; i++) {
+        Pose pose = framePose(i, options);
+        player.setPose(pose.position, pose.direction, pose.plane);
+
+        auto start = std::chrono::steady_clock::now();
+        PROFILE_BEGIN_FRAME();
+        renderFrame(raycaster, state, player, map, i, options);
+        PROFILE_END_FRAME();
+        auto end = std::chrono::steady_clock::now();
+
+        frameMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        pixels += static_cast<double>(raycaster.getRenderWidth()) * raycaster.getRenderHeight();
+
+        if (options.budgetMs > 0.0 && controller.addFrame(static_cast<float>(frameMs.back() / 1000.0))) {
+            raycaster.setRenderResolution(controller.scaledSize(res.width), controller.scaledSize(res.height));
+        }
+
+        if (options.stages) {
+            FrameProfile profile = Profiler::instance().lastFrame();
+            for (int s = 0; s < profileStageCount; s++) stageMs[s] += profile.stageMs[s];
+        }
+    }
+
+    double totalMs = 0.0;
+    for (double ms : frameMs) totalMs += ms;
+    std::sort(frameMs.begin(), frameMs.end());
+
+    double mpixelsPerSecond = pixels / (totalMs / 1000.0) / 1.0e6;
+    double fps = frameCount / (totalMs / 1000.0);
+
+    std::cout << std::fixed << std::setprecision(3)
+              << std::left << std::setw(10) << res.name
+              << " threads=" << raycaster.getThreadCount()
+              << " layout=" << layoutName(options.columnMajor)
+              << " shader=" << getSpanShaderLevelName(getSpanShaderLevel())
+              << " packet=" << raycaster.getPacketWidth()
+              << " walls=" << (options.flat ? "flat" : "textured")
+              << (options.dash ? " dash" : "")
+              << (options.idle ? " idle" : "")
+              << (options.interlace ? " interlace" : "")
+              << " frames=" << frameCount
+              << " mean=" << totalMs / frameCount << "ms"
+              << " p50=" << percentile(frameMs, 0.50) << "ms"
+              << " p90=" << percentile(frameMs, 0.90) << "ms"
+              << " p99=" << percentile(frameMs, 0.99) << "ms"
+              << " max=" << frameMs.back() << "ms"
+              << std::setprecision(1)
+              << " fps=" << fps
+              << " throughput=" << mpixelsPerSecond << " MPixels/s"
+              << std::endl;
+
+    if (options.budgetMs > 0.0) {
+        const ResolutionController::Stats& stats = controller.getStats();
+        std::cout << "           budget=" << options.budgetMs << "ms"
+                  << " scale=" << std::lround(stats.scale * 100.0f) << "%"
+                  << " (" << raycaster.getRenderWidth() << "x" << raycaster.getRenderHeight() << ")"
+                  << " over=" << stats.framesOverBudget << "/" << stats.frames
+                  << " ups=" << stats.scaleUps << " downs=" << stats.scaleDowns << std::endl;
+    }
+
+    if (options.stages) {
+        std::cout << std::setprecision(3) << "           stages:";
+        for (int s = 0; s < profileStageCount; s++) {
+            ProfileStage stage = static_cast<ProfileStage>(s);
+            if (isTopLevelStage(stage) && stageMs[s] > 0.0) {
+                std::cout << " " << getProfileStageName(stage) << "=" << stageMs[s] / frameCount << "ms";
+            }
+        }
+        std::cout << std::endl;
+    }
+    return fps;
+}
+
+void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [--frames N] [--warmup N] [--resolution WxH] [--threads N]" << std::endl
+              << "       [--layout row|column] [--shader scalar|sse4.2|avx2]" << std::endl
+              << "       [--packet 1|4|8] [--flat] [--dash] [--idle] [--interlace] [--verify] [--min-fps N]" << std::endl
+              << "       [--budget MS] [--stages] [--profile-trace FILE] [--profile-csv FILE]" << std::endl
+              << "Without --resolution, runs 640x480, 1920x1080 and 3840x2160." << std::endl
+              << "--threads 0 (default) uses every hardware thread." << std::endl
+              << "--layout column renders through the transposed column-major buffer." << std::endl
+              << "--shader forces a span shading kernel (default: best the CPU supports)." << std::endl
+              << "--packet sets how many rays march through the DDA together (default: widest)." << std::endl
+              << "--flat fills walls with their color instead of sampling the wall textures." << std::endl
+              << "--dash renders repeated dash cycles with all post effects." << std::endl
+              << "--interlace traces alternate columns each frame and estimates the rest." << std::endl
+              << "--idle holds the camera still for " << idleFrames << " frames at a time." << std::endl
+              << "--verify checks the SIMD span kernels against the scalar one, and frames" << std::endl
+              << "         against the single-threaded, row-major, scalar-DDA, full-redraw reference." << std::endl
+              << "         Also checks frames across render resolution changes, and with" << std::endl
+              << "         --interlace reports how closely estimated columns match a full trace." << std::endl
+              << "--budget scales the render resolution to hold frames at MS milliseconds" << std::endl
+              << "         and reports where it settled." << std::endl
+              << "--min-fps fails (exit 2) if a resolution's mean frame rate is below N," << std::endl
+              << "         e.g. --resolution 1920x1080 --threads 1 --min-fps 60." << std::endl
+              << "--stages prints the mean time of each frame stage." << std::endl
+              << "--profile-trace / --profile-csv write the stage timings of the last frames" << std::endl
+              << "         as Chrome trace JSON / CSV. These three need a RAYCASTER_PROFILING build." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    std::vector<Resolution> resolutions = {
+        {640, 480, "640x480"},
+        {1920, 1080, "1080p"},
+        {3840, 2160, "4K"}
+    };
+    std::vector<Resolution> customResolutions;
+    std::vector<std::string> customNames;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            options.frameCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            options.warmupFrames = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threadCount = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--layout" && i + 1 < argc) {
+            std::string layout = argv[++i];
+            if (layout != "row" && layout != "column") {
+                std::cerr << "Invalid layout: " << layout << std::endl;
+                return 1;
+            }
+            options.columnMajor = layout == "column";
+        } else if (arg == "--shader" && i + 1 < argc) {
+            std::string name = argv[++i];
+            SpanShaderLevel level = SpanShaderLevel::Scalar;
+            if (name == "avx2") level = SpanShaderLevel::AVX2;
+            else if (name == "sse4.2") level = SpanShaderLevel::SSE42;
+            else if (name != "scalar") {
+                std::cerr << "Invalid shader: " << name << std::endl;
+                return 1;
+            }
+            if (!setSpanShaderLevel(level)) {
+                std::cerr << "Shader " << name << " is not supported on this CPU" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--packet" && i + 1 < argc) {
+            options.packetWidth = std::atoi(argv[++i]);
+            if (options.packetWidth != 1 && options.packetWidth != 4 && options.packetWidth != 8) {
+                std::cerr << "Invalid packet width: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--flat") {
+            options.flat = true;
+        } else if (arg == "--min-fps" && i + 1 < argc) {
+            options.minFps = std::atof(argv[++i]);
+        } else if (arg == "--dash") {
+            options.dash = true;
+        } else if (arg == "--interlace") {
+            options.interlace = true;
+        } else if (arg == "--idle") {
+            options.idle = true;
+        } else if (arg == "--verify") {
+            options.verify = true;
+        } else if (arg == "--budget" && i + 1 < argc) {
+            options.budgetMs = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--stages") {
+            options.stages = true;
+        } else if (arg == "--profile-trace" && i + 1 < argc) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--profile-csv" && i + 1 < argc) {
+            options.csvPath = argv[++i];
+        } else if (arg == "--resolution" && i + 1 < argc) {
+            int width = 0, height = 0;
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                std::cerr << "Invalid resolution: " << argv[i] << std::endl;
+                return 1;
+            }
+            customNames.push_back(argv[i]);
+            customResolutions.push_back({width, height, nullptr});
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (!customResolutions.empty()) {
+        for (size_t i = 0; i < customResolutions.size(); i++) {
+            customResolutions[i].name = customNames[i].c_str();
+        }
+        resolutions = customResolutions;
+    }
+
+    if (options.verify && !verifySpanShaders()) {
+        return 1;
+    }
+
+    bool profiling = options.stages || !options.tracePath.empty() || !options.csvPath.empty();
+    if (profiling && !RAYCASTER_PROFILING) {
+        std::cerr << "Built without RAYCASTER_PROFILING; no stage timings will be recorded" << std::endl;
+    }
+    Profiler::instance().setEnabled(profiling && !options.verify);
+
+    bool fastEnough = true;
+    for (const auto& res : resolutions) {
+        if (options.verify) {
+            if (!verifyDeterminism(res, options) || !verifyRenderResolution(res, options)) return 1;
+            if (options.interlace && !measureInterlace(res, options)) return 1;
+        } else if (runResolution(res, options) < options.minFps) {
+            std::cerr << res.name << ": below " << options.minFps << " fps" << std::endl;
+            fastEnough = false;
+        }
+    }
+
+    if (!options.tracePath.empty() && !Profiler::instance().writeChromeTrace(options.tracePath)) return 1;
+    if (!options.csvPath.empty() && !Profiler::instance().writeCsv(options.csvPath)) return 1;
+
+    return fastEnough ? 0 : 2;
+}
@@ -0,0 +1,143 @@
+// MapLoadBenchmark.cpp
+// Map loading benchmark: writes a random map in the text and binary formats,
+// then times loadFromFile for each and checks both give the same map.
+#include "Map.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+struct Options {
+    int size = 4096;
+    int repeats = 5;
+    int targetCount = 20000;
+    float density = 0.02f;    // Fraction of interior cells that are walls
+    std::string directory = ".";
+};
+
+void fillMap(Map& map, const Options& options)
+{
+    std::mt19937 rng(options.size);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    std::uniform_int_distribution<int> wallType(1, 5);
+    for (int y = 1; y < map.getHeight() - 1; y++) {
+        for (int x = 1; x < map.getWidth() - 1; x++) {
+            map.setValueAt(x, y, chance(rng) < options.density ? wallType(rng) : 0);
+        }
+    }
+
+    // Walls and duplicate cells are rejected by addTarget, so count what landed
+    std::uniform_int_distribution<int> cell(1, options.size - 2);
+    std::uniform_int_distribution<int> points(1, 50);
+    for (int i = 0; i < options.targetCount; i++) {
+        map.addTarget(cell(rng), cell(rng), points(rng) * 10);
+    }
+}
+
+bool sameMap(const Map& a, const Map& b)
+{
+    if (a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight()) return false;
+    for (int y = 0; y < a.getHeight(); y++) {
+        if (!std::equal(a.getCellData() + y * a.getStride(), a.getCellData() + y * a.getStride() + a.getWidth(),
+                        b.getCellData() + y * b.getStride())) {
+            return false;
+        }
+    }
+
+    // Binary files may regroup targets by chunk; compare by cell
+    if (a.getTargets().size() != b.getTargets().size()) return false;
+    for (const Target& target : a.getTargets()) {
+        int index = b.getTargetIndex(target.x, target.y);
+        if (index == Map::NO_TARGET || b.getTargets()[index].points != target.points ||
+            b.getTargets()[index].hit != target.hit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Best of several loads; each load goes into a fresh map
+double timeLoad(const std::string& path, const Map& expected, const Options& options, bool& matches)
+{
+    double bestSeconds = 0.0;
+    matches = true;
+    for (int repeat = 0; repeat < options.repeats; repeat++) {
+        Map map;
+        auto start = std::chrono::steady_clock::now();
+        if (!map.loadFromFile(path)) {
+            matches = false;
+            return 0.0;
+        }
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (repeat == 0 || seconds < bestSeconds) bestSeconds = seconds;
+        if (repeat == 0) matches = sameMap(expected, map);
+    }
+    return bestSeconds;
+}
+
+void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [--size N] [--targets N] [--repeats N] [--density F] [--dir PATH]" << std::endl
+              << "Writes a random N x N map (default 4096) as text and binary into --dir" << std::endl
+              << "(default: current directory), then times loading each. Files are removed afterwards." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            options.size = std::atoi(argv[++i]);
+            if (options.size < 20 || options.size > Map::MAX_SIZE) {
+                std::cerr << "Invalid map size (20 to " << Map::MAX_SIZE << "): " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--targets" && i + 1 < argc) {
+            options.targetCount = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            options.repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--density" && i + 1 < argc) {
+            options.density = std::min(0.9f, std::max(0.0f, static_cast<float>(std::atof(argv[++i]))));
+        } else if (arg == "--dir" && i + 1 < argc) {
+            options.directory = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    Map map(options.size, options.size);
+    fillMap(map, options);
+
+    std::string textPath = options.directory + "/map_load_benchmark.txt";
+    std::string binaryPath = options.directory + "/map_load_benchmark.rcmap";
+    if (!map.saveToFile(textPath) || !map.saveToBinaryFile(binaryPath)) return 1;
+
+    bool textMatches = false, binaryMatches = false;
+    double textSeconds = timeLoad(textPath, map, options, textMatches);
+    double binarySeconds = timeLoad(binaryPath, map, options, binaryMatches);
+    std::remove(textPath.c_str());
+    std::remove(binaryPath.c_str());
+
+    std::cout << std::fixed << std::setprecision(2)
+              << options.size << "x" << options.size << " targets=" << map.getTargets().size()
+              << " text=" << textSeconds * 1000.0 << " ms"
+              << " binary=" << binarySeconds * 1000.0 << " ms"
+              << std::setprecision(1) << " (" << textSeconds / std::max(binarySeconds, 1e-9) << "x)" << std::endl;
+
+    if (!textMatches || !binaryMatches) {
+        std::cerr << "Loaded map differs from the original (" << (textMatches ? "binary" : "text") << ")" << std::endl;
+        return 1;
+    }
+    return 0;
+}
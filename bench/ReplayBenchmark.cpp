@@ -0,0 +1,263 @@
+// ReplayBenchmark.cpp
+// Replay benchmark: plays a replay log back headless at full speed,
+// checking every recorded state hash, and reports simulation steps per
+// second and step (or, with --render, whole frame) times. --generate writes
+// a log of a scripted session to play, so runs can be compared across
+// builds and machines; --loops repeats the playback as a soak test.
+#include "Replay.hpp"
+#include "Simulation.hpp"
+#include "RayCaster.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string replayPath;
+    std::string generatePath;
+    std::uint64_t generateSteps = 36000;  // Ten minutes at 60 steps/second
+    std::uint32_t seed = 1;
+    int loops = 1;
+    int width = 0;                        // Render each step at this size; 0 = simulate only
+    int height = 0;
+    long long perturbStep = -1;           // Nudge the player after this step, to check divergence is caught
+};
+
+const float stepSeconds = 1.0f / 60.0f;   // Game::simulationStep
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void printTimes(const char* name, std::vector<double> us)
+{
+    if (us.empty()) return;
+    double total = 0.0;
+    for (double t : us) total += t;
+    std::sort(us.begin(), us.end());
+    std::cout << std::fixed << std::setprecision(3) << name
+              << " mean=" << total / us.size() << "us"
+              << " p50=" << percentile(us, 0.5) << "us"
+              << " p99=" << percentile(us, 0.99) << "us"
+              << " max=" << us.back() << "us" << std::endl;
+}
+
+// The game's starting state: the built-in map with fresh targets
+void resetWorld(Map& map, Player& player)
+{
+    map = Map(20, 20);
+    map.resetTargets();
+    player = Player();
+}
+
+// A wandering session: runs of random held buttons, dashing now and then.
+// It opens with a dash through the target at (8, 3): from the start at
+// (5, 5) facing +x, strafe left onto row 3 and dash along it. Then the
+// checkpoints cover target hits and the score whatever the seed does later.
+const std::uint64_t openingStrafeSteps = 55;   // 1.65 cells/s strafe to y ~= 3.5
+const std::uint64_t openingSteps = openingStrafeSteps + 30;   // Dash and its cooldown
+
+InputState scriptedInput(std::uint64_t step, std::uint32_t seed)
+{
+    if (step < openingSteps) {
+        InputState input;
+        input.setDown(InputStrafeLeft, step < openingStrafeSteps);
+        input.setDown(InputDash, step == openingStrafeSteps);
+        return input;
+    }
+
+    std::uint32_t state = seed * 2654435761u + static_cast<std::uint32_t>(step / 20) * 40503u;
+    state ^= state >> 15;
+    state *= 2246822519u;
+    state ^= state >> 13;
+
+    InputState input;
+    input.setDown(InputForward, (state & 3) != 0);
+    input.setDown(InputBackward, (state & 3) == 0);
+    input.setDown(InputStrafeLeft, (state & 12) == 4);
+    input.setDown(InputStrafeRight, (state & 12) == 8);
+    input.setDown(InputTurnLeft, (state & 48) == 16);
+    input.setDown(InputTurnRight, (state & 48) == 32);
+    input.setDown(InputDash, (state & 0x300) == 0 && step % 20 < 2);
+    return input;
+}
+
+bool generate(const Options& options)
+{
+    Map map;
+    Player player;
+    resetWorld(map, player);
+    int score = 0;
+
+    ReplayHeader header = {};
+    header.checkpointInterval = 60;
+    header.stepSeconds = stepSeconds;
+    header.startPosition[0] = player.getPosition().x;
+    header.startPosition[1] = player.getPosition().y;
+    header.startDirection[0] = player.getDirection().x;
+    header.startDirection[1] = player.getDirection().y;
+    header.startPlane[0] = player.getPlane().x;
+    header.startPlane[1] = player.getPlane().y;
+    header.mapHash = hashMapLayout(map);
+    header.startHash = hashSimulationState(player, map, score);
+
+    ReplayRecorder recorder;
+    if (!recorder.open(options.generatePath, header)) return false;
+    for (std::uint64_t step = 0; step < options.generateSteps; step++) {
+        InputState input = scriptedInput(step, options.seed);
+        score += stepSimulation(player, map, input, stepSeconds);
+        recorder.record(input);
+        if (recorder.isCheckpointDue()) recorder.checkpoint(hashSimulationState(player, map, score));
+    }
+    if (!recorder.close(hashSimulationState(player, map, score))) return false;
+
+    // A session that never scores leaves target hits unchecked
+    if (score == 0) {
+        std::cerr << "Error: The scripted session in " << options.generatePath
+                  << " hit no targets; its checkpoints don't cover scoring" << std::endl;
+        return false;
+    }
+
+    std::cout << "Wrote " << options.generateSteps << " steps to " << options.generatePath
+              << " (score " << score << ")" << std::endl;
+    return true;
+}
+
+void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " --replay FILE.rcreplay [--loops N] [--render WxH] [--perturb STEP]" << std::endl
+              << "       " << program << " --generate FILE.rcreplay [--steps N] [--seed N]" << std::endl
+              << "--replay plays a log back and checks every recorded state hash." << std::endl
+              << "--loops plays it N times from the start (default 1)." << std::endl
+              << "--render traces and shades every step headless at WxH." << std::endl
+              << "--perturb nudges the player after STEP steps; playback must then diverge." << std::endl
+              << "--generate writes a scripted session of --steps steps (default 36000)." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--replay" && i + 1 < argc) {
+            options.replayPath = argv[++i];
+        } else if (arg == "--generate" && i + 1 < argc) {
+            options.generatePath = argv[++i];
+        } else if (arg == "--steps" && i + 1 < argc) {
+            options.generateSteps = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--loops" && i + 1 < argc) {
+            options.loops = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--perturb" && i + 1 < argc) {
+            options.perturbStep = std::atoll(argv[++i]);
+        } else if (arg == "--render" && i + 1 < argc) {
+            std::string value = argv[++i];
+            size_t x = value.find('x');
+            options.width = x == std::string::npos ? 0 : std::atoi(value.substr(0, x).c_str());
+            options.height = x == std::string::npos ? 0 : std::atoi(value.substr(x + 1).c_str());
+            if (options.width <= 0 || options.height <= 0) {
+                std::cerr << "Invalid resolution: " << value << std::endl;
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (!options.generatePath.empty()) {
+        if (!generate(options)) return 1;
+        if (options.replayPath.empty()) return 0;
+    }
+    if (options.replayPath.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    ReplayInput replay;
+    if (!replay.open(options.replayPath)) return 1;
+    const ReplayHeader& header = replay.getHeader();
+    if (header.stepSeconds != stepSeconds) {
+        std::cerr << "Replay was recorded with " << header.stepSeconds << " s steps, not " << stepSeconds << std::endl;
+        return 1;
+    }
+
+    bool rendering = options.width > 0;
+    std::unique_ptr<RayCaster> raycaster;
+    if (rendering) raycaster = std::make_unique<RayCaster>(options.width, options.height, true);
+    FrameState state;
+
+    Map map;
+    Player player;
+    std::vector<double> stepUs;
+    stepUs.reserve(replay.getStepCount() * options.loops);
+    std::uint64_t totalSteps = 0;
+    int diverged = 0;
+    int finalScore = 0;
+    auto runStart = std::chrono::steady_clock::now();
+
+    for (int loop = 0; loop < options.loops; loop++) {
+        resetWorld(map, player);
+        int score = 0;
+        if (hashMapLayout(map) != header.mapHash) {
+            std::cerr << "Replay was recorded on a different map" << std::endl;
+            return 1;
+        }
+        player.setPose(sf::Vector2f(header.startPosition[0], header.startPosition[1]),
+                       sf::Vector2f(header.startDirection[0], header.startDirection[1]),
+                       sf::Vector2f(header.startPlane[0], header.startPlane[1]));
+        if (hashSimulationState(player, map, score) != header.startHash) {
+            std::cerr << "Replay starts from a different game state" << std::endl;
+            return 1;
+        }
+
+        replay.rewind();
+        InputState input;
+        bool matched = true;
+        while (replay.next(input)) {
+            auto stepStart = std::chrono::steady_clock::now();
+            score += stepSimulation(player, map, input, header.stepSeconds);
+            if (rendering) {
+                raycaster->traceFrame(player, map, state);
+                raycaster->renderFrame(state, player, map);
+            }
+            auto stepEnd = std::chrono::steady_clock::now();
+            stepUs.push_back(std::chrono::duration<double, std::micro>(stepEnd - stepStart).count());
+
+            std::uint64_t step = replay.getStepsPlayed();
+            if (static_cast<long long>(step) == options.perturbStep) {
+                player.setPose(player.getPosition() + sf::Vector2f(0.001f, 0.0f), player.getDirection(), player.getPlane());
+            }
+            if (replay.hasCheckpoint(step) && !replay.verify(step, hashSimulationState(player, map, score))) {
+                matched = false;
+                break;
+            }
+        }
+        totalSteps += replay.getStepsPlayed();
+        if (!matched) diverged++;
+        finalScore = score;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+    std::cout << std::fixed << std::setprecision(1)
+              << options.replayPath << ": " << replay.getStepCount() << " steps x " << options.loops << " loops"
+              << (rendering ? " rendered at " + std::to_string(options.width) + "x" + std::to_string(options.height) : "")
+              << ", " << totalSteps / seconds << " steps/s"
+              << ", score " << finalScore
+              << ", " << (diverged == 0 ? "all checkpoints matched" : std::to_string(diverged) + " loops diverged")
+              << std::endl;
+    printTimes(rendering ? "frame" : "step ", stepUs);
+    return diverged == 0 ? 0 : 2;
+}
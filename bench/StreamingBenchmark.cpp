@@ -0,0 +1,158 @@
+// StreamingBenchmark.cpp
+// Streaming world benchmark: flies the camera in a straight line across a
+// procedural world (or a binary map file) and reports the time spent
+// streaming, frame times, cache size against the budget, and frames where
+// the chunk under the camera hadn't arrived yet.
+#include "StreamingWorld.hpp"
+#include "RayCaster.hpp"
+#include "Player.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int frameCount = 3000;
+    int width = 1280;
+    int height = 720;
+    float speed = 1.0f;           // Cells per frame
+    int windowChunks = 9;
+    std::size_t budgetBytes = std::size_t(4) << 20;
+    std::uint32_t seed = 1;
+    std::string mapPath;
+};
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void printTimes(const char* name, std::vector<double> ms)
+{
+    double total = 0.0;
+    for (double t : ms) total += t;
+    std::sort(ms.begin(), ms.end());
+    std::cout << std::fixed << std::setprecision(3) << name
+              << " mean=" << total / ms.size() << "ms"
+              << " p99=" << percentile(ms, 0.99) << "ms"
+              << " max=" << ms.back() << "ms" << std::endl;
+}
+
+void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [--frames N] [--resolution WxH] [--speed CELLS] [--window N]" << std::endl
+              << "       [--budget MB] [--seed N] [--map FILE.rcmap]" << std::endl
+              << "--speed is how far the camera moves per frame (default 1 cell)." << std::endl
+              << "--window sets the streamed window in chunks per side (default 9)." << std::endl
+              << "--budget sets the chunk cache budget (default 4 MB)." << std::endl
+              << "--map streams a binary map file instead of the procedural world." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            options.frameCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--resolution" && i + 1 < argc) {
+            std::string value = argv[++i];
+            size_t x = value.find('x');
+            options.width = x == std::string::npos ? 0 : std::atoi(value.substr(0, x).c_str());
+            options.height = x == std::string::npos ? 0 : std::atoi(value.substr(x + 1).c_str());
+            if (options.width <= 0 || options.height <= 0) {
+                std::cerr << "Invalid resolution: " << value << std::endl;
+                return 1;
+            }
+        } else if (arg == "--speed" && i + 1 < argc) {
+            options.speed = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--window" && i + 1 < argc) {
+            options.windowChunks = std::atoi(argv[++i]);
+        } else if (arg == "--budget" && i + 1 < argc) {
+            options.budgetBytes = static_cast<std::size_t>(std::max(0.0, std::atof(argv[++i])) * (1 << 20));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--map" && i + 1 < argc) {
+            options.mapPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // Start in the middle of the map file, or of the origin chunk, and head
+    // off diagonally
+    std::unique_ptr<ChunkSource> source;
+    sf::Vector2i start(StreamingWorld::chunkSize / 2, StreamingWorld::chunkSize / 2);
+    if (!options.mapPath.empty()) {
+        auto file = std::make_unique<MapFileChunkSource>();
+        if (!file->open(options.mapPath)) return 1;
+        start = sf::Vector2i(file->getWidth() / 4, file->getHeight() / 4);
+        source = std::move(file);
+    } else {
+        source = std::make_unique<ProceduralChunkSource>(options.seed);
+    }
+
+    Map map;
+    StreamingWorld world(std::move(source), options.windowChunks, options.budgetBytes);
+    sf::Vector2f position = world.start(map, start);
+
+    Player player;
+    FrameState state;
+    RayCaster raycaster(options.width, options.height, true);
+    sf::Vector2f travel(0.8f, 0.6f);
+
+    std::vector<double> streamMs, frameMs;
+    std::size_t peakBytes = 0;
+    int blindFrames = 0;
+    for (int frame = 0; frame < options.frameCount; frame++) {
+        position += travel * options.speed;
+
+        auto streamStart = std::chrono::steady_clock::now();
+        sf::Vector2i shift = world.update(map, position);
+        auto streamEnd = std::chrono::steady_clock::now();
+        position -= sf::Vector2f(static_cast<float>(shift.x), static_cast<float>(shift.y));
+
+        sf::Vector2i cell = world.getOrigin() + sf::Vector2i(static_cast<int>(position.x), static_cast<int>(position.y));
+        int chunkX = static_cast<int>(std::floor(static_cast<float>(cell.x) / StreamingWorld::chunkSize));
+        int chunkY = static_cast<int>(std::floor(static_cast<float>(cell.y) / StreamingWorld::chunkSize));
+        if (!world.isChunkLoaded(chunkX, chunkY)) blindFrames++;
+
+        // Look along the path, swaying so the view sweeps across chunks
+        float heading = std::atan2(travel.y, travel.x) + 0.785f * std::sin(frame * 0.05f);
+        sf::Vector2f direction(std::cos(heading), std::sin(heading));
+        player.setPose(position, direction, sf::Vector2f(-direction.y * 0.66f, direction.x * 0.66f));
+
+        raycaster.traceFrame(player, map, state);
+        raycaster.renderFrame(state, player, map);
+        auto frameEnd = std::chrono::steady_clock::now();
+
+        streamMs.push_back(std::chrono::duration<double, std::milli>(streamEnd - streamStart).count());
+        frameMs.push_back(std::chrono::duration<double, std::milli>(frameEnd - streamStart).count());
+        peakBytes = std::max(peakBytes, world.getStats().cachedBytes);
+    }
+
+    StreamingWorld::Stats stats = world.getStats();
+    double distance = options.speed * options.frameCount;
+    std::cout << std::fixed << std::setprecision(1)
+              << options.width << "x" << options.height << " window=" << options.windowChunks << "x" << options.windowChunks
+              << " distance=" << distance << " cells"
+              << " loads=" << stats.loads << " evictions=" << stats.evictions << " shifts=" << stats.shifts
+              << " cache=" << stats.cachedChunks << " chunks"
+              << " peak=" << peakBytes / 1024.0 << "KB budget=" << options.budgetBytes / 1024.0 << "KB"
+              << " blind frames=" << blindFrames << std::endl;
+    printTimes("stream", streamMs);
+    printTimes("frame ", frameMs);
+    return 0;
+}
@@ -0,0 +1,52 @@
+// Camera.cpp
+#include "Camera.hpp"
+#include <cmath>
+
+void Camera::setResolution(int newWidth, int newHeight)
+{
+    if (newWidth == width && newHeight == height) return;
+    width = std::max(0, newWidth);
+    height = std::max(0, newHeight);
+    screenHeight = static_cast<float>(height);
+    halfWidth = 0.5f * width;
+
+    cameraX.resize(width);
+    for (int x = 0; x < width; x++) {
+        cameraX[x] = 2 * x / static_cast<float>(width) - 1;
+    }
+
+    // Rows below the horizon see the floor, rows above the ceiling, at the
+    // same distances mirrored
+    int horizon = height / 2;
+    rowDistances.resize(height);
+    for (int y = 0; y < height; y++) {
+        float offset = y >= horizon ? y - horizon + 0.5f : horizon - y - 0.5f;
+        rowDistances[y] = 0.5f * screenHeight / offset;
+    }
+}
+
+void Camera::setView(sf::Vector2f newPosition, sf::Vector2f newDirection, sf::Vector2f newPlane)
+{
+    position = newPosition;
+    direction = newDirection;
+    plane = newPlane;
+
+    float det = plane.x * direction.y - direction.x * plane.y;
+    inverseDeterminant = det != 0.0f ? 1.0f / det : 0.0f;
+    float planeLength = std::sqrt(plane.x * plane.x + plane.y * plane.y);
+    inversePlaneLength = planeLength > 0.0f ? 1.0f / planeLength : 0.0f;
+}
+
+void Camera::toCameraSpace(sf::Vector2f point, float& depth, float& planeX) const
+{
+    float dx = point.x - position.x;
+    float dy = point.y - position.y;
+    depth = inverseDeterminant * (-plane.y * dx + plane.x * dy);
+    planeX = inverseDeterminant * (direction.y * dx - direction.x * dy);
+}
+
+int Camera::projectColumn(float planeX, float depth) const
+{
+    float column = halfWidth * (1.0f + planeX / depth);
+    return static_cast<int>(std::floor(std::max(-1.0e6f, std::min(1.0e6f, column))));
+}
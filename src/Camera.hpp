@@ -0,0 +1,73 @@
+// Camera.hpp
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <vector>
+
+// Projection between the map and a screen of width x height pixels, shared by
+// the ray tracer, the floor pass and sprite projection. Everything that only
+// depends on the resolution (where each column sits on the camera plane, how
+// far each floor row looks) is tabled once per resize; setView caches what
+// depends on the pose, so per-column work is a few multiply-adds.
+class Camera {
+public:
+    // Rebuild the column and row tables; cheap to call with an unchanged size
+    void setResolution(int width, int height);
+    // Pose for the coming frame. plane is the camera plane's half width.
+    void setView(sf::Vector2f position, sf::Vector2f direction, sf::Vector2f plane);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    sf::Vector2f getPosition() const { return position; }
+    sf::Vector2f getDirection() const { return direction; }
+    sf::Vector2f getPlane() const { return plane; }
+
+    // Column x's position on the camera plane, -1 at the left edge to 1 at the right
+    float getCameraX(int x) const { return cameraX[x]; }
+
+    // Ray through column x: its camera-space direction (1, cameraX) rotated
+    // into the map by the view's direction and plane
+    sf::Vector2f rayDirection(int x) const
+    {
+        return sf::Vector2f(direction.x + plane.x * cameraX[x], direction.y + plane.y * cameraX[x]);
+    }
+
+    // Height in pixels of a one-cell-tall slice at this perpendicular distance.
+    // A true division: each hit has its own distance, so a reciprocal would
+    // cost one too, and rounding it could move a slice edge by a pixel.
+    int lineHeight(float distance) const { return static_cast<int>(screenHeight / distance); }
+    // Rows [start, end] a slice of this height covers, centred on the horizon
+    // and clipped to the screen
+    void spanRows(int lineHeight, int& start, int& end) const
+    {
+        start = std::max(0, -lineHeight / 2 + height / 2);
+        end = std::min(height - 1, lineHeight / 2 + height / 2);
+    }
+
+    // Distance to the floor (or ceiling) point row y sees through its pixel centre
+    float getRowDistance(int y) const { return rowDistances[y]; }
+
+    // Map point to camera space: depth along the view axis, cameraX across
+    // the plane in the same units as getCameraX (before dividing by depth)
+    void toCameraSpace(sf::Vector2f point, float& depth, float& planeX) const;
+    // Screen column of camera-plane coordinate planeX at this depth; clamped
+    // so points right in front of the camera don't overflow
+    int projectColumn(float planeX, float depth) const;
+    // Map distance to camera-plane units: a billboard's half width across the plane
+    float toPlaneUnits(float cells) const { return cells * inversePlaneLength; }
+
+    // A view with no area (zero or parallel direction and plane) projects nothing
+    bool isDegenerate() const { return inverseDeterminant == 0.0f; }
+
+private:
+    int width = 0, height = 0;
+    float screenHeight = 0.0f;
+    float halfWidth = 0.0f;
+
+    std::vector<float> cameraX;          // Per column
+    std::vector<float> rowDistances;     // Per row
+
+    sf::Vector2f position, direction, plane;
+    float inverseDeterminant = 0.0f;     // Of the camera-to-map matrix [plane direction]
+    float inversePlaneLength = 0.0f;
+};
@@ -0,0 +1,150 @@
+// ChunkSource.cpp
+#include "ChunkSource.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// splitmix64: small, and the same sequence on every platform
+struct ChunkRandom {
+    std::uint64_t state;
+
+    std::uint64_t next()
+    {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform enough in [low, high] for level generation
+    int range(int low, int high)
+    {
+        return low + static_cast<int>(next() % static_cast<std::uint64_t>(high - low + 1));
+    }
+};
+
+} // namespace
+
+bool ProceduralChunkSource::loadChunk(int chunkX, int chunkY, int size, WorldChunk& chunk)
+{
+    ChunkRandom random{worldChunkKey(chunkX, chunkY) * 0x2545F4914F6CDD1Dull ^ seed};
+    chunk.cells.assign(static_cast<std::size_t>(size) * size, 0);
+    chunk.targets.clear();
+    auto cell = [&](int x, int y) -> std::uint8_t& { return chunk.cells[static_cast<std::size_t>(y) * size + x]; };
+
+    // Each chunk owns its west and north walls, so the doorways of a shared
+    // wall are decided once and both neighbours agree on them
+    const int door = std::max(2, size / 16);
+    int westType = random.range(1, 5), northType = random.range(1, 5);
+    int westDoor = random.range(2, size - door - 2), northDoor = random.range(2, size - door - 2);
+    for (int i = 0; i < size; i++) {
+        if (i < westDoor || i >= westDoor + door) cell(0, i) = static_cast<std::uint8_t>(westType);
+        if (i < northDoor || i >= northDoor + door) cell(i, 0) = static_cast<std::uint8_t>(northType);
+    }
+
+    // Pillars and short walls inside the room
+    int pillars = size * size / 256;
+    for (int i = 0; i < pillars; i++) {
+        int x = random.range(2, size - 4), y = random.range(2, size - 4);
+        int type = random.range(1, 5);
+        bool wall = random.range(0, 3) == 0;
+        int length = wall ? random.range(3, std::max(3, size / 6)) : 2;
+        bool horizontal = random.range(0, 1) == 0;
+        for (int j = 0; j < length; j++) {
+            int wx = std::min(size - 2, x + (horizontal ? j : 0));
+            int wy = std::min(size - 2, y + (horizontal ? 0 : j));
+            cell(wx, wy) = static_cast<std::uint8_t>(type);
+            if (!wall) cell(std::min(size - 2, wx + 1), wy) = static_cast<std::uint8_t>(type);
+        }
+    }
+
+    // Keep the middle of the origin chunk open to start in
+    if (chunkX == 0 && chunkY == 0) {
+        for (int y = size / 2 - 3; y <= size / 2 + 3; y++) {
+            std::fill_n(&cell(size / 2 - 3, y), 7, 0);
+        }
+    }
+
+    int targetCount = random.range(2, 5);
+    for (int i = 0; i < targetCount; i++) {
+        int x = random.range(1, size - 2), y = random.range(1, size - 2);
+        if (cell(x, y) == 0) chunk.targets.push_back(Target{x, y, random.range(1, 5) * 10, false});
+    }
+    return true;
+}
+
+bool MapFileChunkSource::open(const std::string& filename)
+{
+    binnedSize = 0;
+    binnedTargets.clear();
+    if (!file.open(filename)) return false;
+    if (!readMapFileHeader(file, filename, header)) {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool MapFileChunkSource::loadChunk(int chunkX, int chunkY, int size, WorldChunk& chunk)
+{
+    if (!file.isOpen()) return false;
+
+    // Chunks past the edge don't exist; partial ones are padded with wall
+    long long left = static_cast<long long>(chunkX) * size, top = static_cast<long long>(chunkY) * size;
+    if (left < 0 || top < 0 || left >= header.width || top >= header.height) return false;
+    int columns = static_cast<int>(std::min<long long>(size, header.width - left));
+    int rows = static_cast<int>(std::min<long long>(size, header.height - top));
+
+    chunk.cells.assign(static_cast<std::size_t>(size) * size, 1);
+    const std::uint8_t* grid = file.data() + header.cellsOffset;
+    std::uint64_t stride = mapFileStride(header);
+    for (int y = 0; y < rows; y++) {
+        const std::uint8_t* row = grid + (top + y + header.padding) * stride + header.padding + left;
+        std::memcpy(chunk.cells.data() + static_cast<std::size_t>(y) * size, row, columns);
+    }
+
+    // The file's chunk index lists this chunk's targets directly if its
+    // chunks are the same size; otherwise bin all targets once
+    const MapFileTarget* records = reinterpret_cast<const MapFileTarget*>(file.data() + header.targetsOffset);
+    const MapFileTarget* first = nullptr;
+    std::size_t count = 0;
+    if (static_cast<int>(header.chunkSize) == size) {
+        std::uint64_t chunksX = (static_cast<std::uint64_t>(header.width) + size - 1) / size;
+        MapFileChunk record;
+        std::memcpy(&record, file.data() + header.chunksOffset + (chunkY * chunksX + chunkX) * sizeof(record), sizeof(record));
+        if (record.firstTarget <= header.targetCount && record.targetCount <= header.targetCount - record.firstTarget) {
+            first = records + record.firstTarget;
+            count = record.targetCount;
+        }
+    } else {
+        if (binnedSize != size) {
+            binnedTargets.clear();
+            for (std::uint64_t i = 0; i < header.targetCount; i++) {
+                MapFileTarget target;
+                std::memcpy(&target, &records[i], sizeof(target));
+                if (target.x < 0 || target.y < 0 || target.x >= header.width || target.y >= header.height) continue;
+                binnedTargets[worldChunkKey(target.x / size, target.y / size)].push_back(target);
+            }
+            binnedSize = size;
+        }
+        auto found = binnedTargets.find(worldChunkKey(chunkX, chunkY));
+        if (found != binnedTargets.end()) {
+            first = found->second.data();
+            count = found->second.size();
+        }
+    }
+
+    // Skip anything that isn't inside this chunk (a damaged index)
+    chunk.targets.clear();
+    for (std::size_t i = 0; i < count; i++) {
+        MapFileTarget target;
+        std::memcpy(&target, first + i, sizeof(target));
+        long long x = target.x - left, y = target.y - top;
+        if (x < 0 || y < 0 || x >= columns || y >= rows) continue;
+        chunk.targets.push_back(Target{static_cast<int>(x), static_cast<int>(y), target.points,
+                                       (target.flags & mapFileTargetHit) != 0});
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+// ChunkSource.hpp
+#pragma once
+#include "Map.hpp"
+#include "MappedFile.hpp"
+#include "MapFile.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One square block of a streamed world, as a chunk source produces it
+struct WorldChunk {
+    std::vector<std::uint8_t> cells;   // size x size wall types, row-major
+    std::vector<Target> targets;       // Positions relative to the chunk corner
+};
+
+// Chunk coordinates packed into one hashable key
+inline std::uint64_t worldChunkKey(int chunkX, int chunkY)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(chunkY)) << 32) | static_cast<std::uint32_t>(chunkX);
+}
+
+inline int worldChunkX(std::uint64_t key) { return static_cast<std::int32_t>(key & 0xffffffffu); }
+inline int worldChunkY(std::uint64_t key) { return static_cast<std::int32_t>(key >> 32); }
+
+// Where a StreamingWorld gets its chunks from. loadChunk runs on the
+// world's loader thread, one call at a time.
+class ChunkSource {
+public:
+    virtual ~ChunkSource() = default;
+
+    // Fill chunk (chunkX, chunkY), size x size cells. False if the world
+    // has no such chunk; it then stays solid wall.
+    virtual bool loadChunk(int chunkX, int chunkY, int size, WorldChunk& chunk) = 0;
+};
+
+// Endless generated world: every chunk is a room with doorways into its
+// neighbours, pillars and a few targets, the same every time for a seed
+class ProceduralChunkSource : public ChunkSource {
+public:
+    explicit ProceduralChunkSource(std::uint32_t seed) : seed(seed) {}
+
+    bool loadChunk(int chunkX, int chunkY, int size, WorldChunk& chunk) override;
+
+private:
+    std::uint32_t seed;
+};
+
+// Chunks cut out of a binary map file (MapFile.hpp), read straight from
+// the mapping, so only the parts of the file that get visited are paged in.
+// Chunks outside the map don't exist.
+class MapFileChunkSource : public ChunkSource {
+public:
+    bool open(const std::string& filename);   // Prints why on failure
+
+    bool loadChunk(int chunkX, int chunkY, int size, WorldChunk& chunk) override;
+
+    int getWidth() const { return header.width; }
+    int getHeight() const { return header.height; }
+
+private:
+    MappedFile file;
+    MapFileHeader header = {};
+
+    // Targets by chunk of the file's own chunk index if it has one, otherwise
+    // binned once on the first load with a new chunk size
+    int binnedSize = 0;
+    std::unordered_map<std::uint64_t, std::vector<MapFileTarget>> binnedTargets;
+};
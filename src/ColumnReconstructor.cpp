@@ -0,0 +1,96 @@
+// ColumnReconstructor.cpp
+#include "ColumnReconstructor.hpp"
+#include <limits>
+
+void ColumnReconstructor::reproject(const HitBuffer& previous, int sourceParity, sf::Vector2f position,
+    sf::Vector2f direction, sf::Vector2f plane, const Camera& camera)
+{
+    int width = camera.getWidth();
+    history = previous;
+    sources.assign(width, -1);
+    sourceDepths.assign(width, std::numeric_limits<float>::max());
+    if (history.size() != width || camera.isDegenerate()) return;
+
+    for (int x = 0; x < width; x++) {
+        if (sourceParity >= 0 && (x & 1) != sourceParity) continue;
+
+        // The old hit in the map, then in the new view. Where two land on
+        // one column the nearer hides the other.
+        float cameraX = camera.getCameraX(x);
+        sf::Vector2f ray(direction.x + plane.x * cameraX, direction.y + plane.y * cameraX);
+        sf::Vector2f point = position + ray * history.distance[x];
+
+        float depth, planeX;
+        camera.toCameraSpace(point, depth, planeX);
+        if (depth <= 0.0f) continue;
+        int column = camera.projectColumn(planeX, depth);
+        if (column < 0 || column >= width || depth >= sourceDepths[column]) continue;
+
+        sources[column] = x;
+        sourceDepths[column] = depth;
+    }
+}
+
+void ColumnReconstructor::reconstruct(int begin, int end, int parity, HitBuffer& hits, const Camera& camera) const
+{
+    sf::Vector2f pos = camera.getPosition();
+    int width = hits.size();
+    bool haveSources = static_cast<int>(sources.size()) == width;
+
+    for (int x = begin + ((begin & 1) != parity); x < end; x += 2) {
+        sf::Vector2f dir = camera.rayDirection(x);
+        RayHit best = {};
+        best.distance = std::numeric_limits<float>::max();
+        float bestWallX = 0.0f;
+
+        // Where this column's ray crosses the face of a hit cell, if it does;
+        // the nearest crossing so far wins
+        auto tryFace = [&](const HitBuffer& from, int i) {
+            int side = from.side[i];
+            int mapX = from.mapX[i];
+            int mapY = from.mapY[i];
+            float distance, wallX;
+            if (side == 0) {
+                if (dir.x == 0.0f) return;
+                float faceX = static_cast<float>(dir.x > 0.0f ? mapX : mapX + 1);
+                distance = (faceX - pos.x) / dir.x;
+                wallX = pos.y + distance * dir.y;
+                if (wallX < mapY || wallX >= mapY + 1) return;
+            } else {
+                if (dir.y == 0.0f) return;
+                float faceY = static_cast<float>(dir.y > 0.0f ? mapY : mapY + 1);
+                distance = (faceY - pos.y) / dir.y;
+                wallX = pos.x + distance * dir.x;
+                if (wallX < mapX || wallX >= mapX + 1) return;
+            }
+            if (distance <= 0.0f || distance >= best.distance) return;
+
+            best.mapX = mapX;
+            best.mapY = mapY;
+            best.side = side;
+            best.wallType = from.wallType[i];
+            best.distance = distance;
+            bestWallX = wallX;
+        };
+
+        if (haveSources && sources[x] >= 0) tryFace(history, sources[x]);
+        if (x > 0) tryFace(hits, x - 1);
+        if (x + 1 < width) tryFace(hits, x + 1);
+
+        if (best.distance != std::numeric_limits<float>::max()) {
+            hits.store(x, best, faceTextureU(best.side, bestWallX, dir), camera.lineHeight(best.distance));
+            continue;
+        }
+
+        // No face fits: take the nearer traced neighbour as it is
+        int from = x + 1 < width && (x == 0 || hits.distance[x + 1] < hits.distance[x - 1]) ? x + 1 : x - 1;
+        if (from < 0) continue;
+        hits.distance[x] = hits.distance[from];
+        hits.side[x] = hits.side[from];
+        hits.wallType[x] = hits.wallType[from];
+        hits.mapX[x] = hits.mapX[from];
+        hits.mapY[x] = hits.mapY[from];
+        hits.textureU[x] = hits.textureU[from];
+        hits.lineHeight[x] = hits.lineHeight[from];
+    }
+}
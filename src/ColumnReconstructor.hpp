@@ -0,0 +1,34 @@
+// ColumnReconstructor.hpp
+#pragma once
+#include "Camera.hpp"
+#include "FrameState.hpp"
+#include <vector>
+
+// Interlaced tracing: each frame traces only the columns of one parity and
+// rebuilds the others, which the previous frame traced, from their old hits.
+//
+// reproject() moves each old hit's world point into the new view to find
+// the column that now sees it. reconstruct() then intersects each missing
+// column's ray with the wall faces that could cover it: the reprojected hit's
+// face and the faces its traced neighbours hit. The nearest face the ray
+// really crosses wins, which is exact whenever one of them is the wall the
+// column sees. If none is crossed (a disocclusion, or a view that turned a
+// long way) the nearer neighbour's hit is copied.
+class ColumnReconstructor {
+public:
+    // Keep the previous frame's hits (traced from position, direction, plane)
+    // and splat them into camera's view. sourceParity picks the columns that
+    // were really traced; -1 uses every column.
+    void reproject(const HitBuffer& previous, int sourceParity, sf::Vector2f position,
+                   sf::Vector2f direction, sf::Vector2f plane, const Camera& camera);
+
+    // Rebuild the columns of [begin, end) with the given parity. Their
+    // neighbours must already be traced for this frame. Columns are
+    // independent, so ranges can be split across threads.
+    void reconstruct(int begin, int end, int parity, HitBuffer& hits, const Camera& camera) const;
+
+private:
+    HitBuffer history;                  // The previous frame's hits
+    std::vector<int> sources;           // Per column: index into history that reprojects here, or -1
+    std::vector<float> sourceDepths;    // Its depth in the new view, for the nearest-wins splat
+};
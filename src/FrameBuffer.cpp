@@ -0,0 +1,119 @@
+// FrameBuffer.cpp
+#include "FrameBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+FrameBuffer::FrameBuffer(int width, int height)
+    : width(0), height(0), capacity(0)
+{
+    resize(width, height);
+}
+
+void FrameBuffer::resize(int newWidth, int newHeight)
+{
+    newWidth = std::max(0, newWidth);
+    newHeight = std::max(0, newHeight);
+    if (newWidth == width && newHeight == height && pixels) return;
+
+    width = newWidth;
+    height = newHeight;
+
+    std::size_t count = std::max<std::size_t>(1, getPixelCount());
+    if (count > capacity || !pixels) {
+        pixels.reset(static_cast<Pixel*>(::operator new[](count * sizeof(Pixel), std::align_val_t(alignment))));
+        capacity = count;
+    }
+    clear(packColor(0, 0, 0));
+}
+
+void FrameBuffer::clear(Pixel color)
+{
+    std::fill(pixels.get(), pixels.get() + getPixelCount(), color);
+}
+
+void FrameBuffer::copyFrom(const FrameBuffer& other)
+{
+    resize(other.width, other.height);
+    std::memcpy(pixels.get(), other.pixels.get(), getPixelCount() * sizeof(Pixel));
+}
+
+void FrameBuffer::fillRect(int x, int y, int w, int h, Pixel color)
+{
+    int x0 = std::max(0, x);
+    int y0 = std::max(0, y);
+    int x1 = std::min(width, x + w);
+    int y1 = std::min(height, y + h);
+    if (x0 >= x1) return;
+
+    for (int py = y0; py < y1; py++) {
+        std::fill(row(py) + x0, row(py) + x1, color);
+    }
+}
+
+namespace {
+
+const int transposeBlock = 8;   // 8x8 pixel blocks, 32 bytes per block row
+
+#if defined(__SSE2__)
+// Transpose a 4x4 pixel block with SSE2 unpacks
+inline void transpose4x4(const Pixel* src, std::ptrdiff_t srcStride, Pixel* dst, std::ptrdiff_t dstStride)
+{
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + srcStride));
+    __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * srcStride));
+    __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * srcStride));
+
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);   // a0 b0 a1 b1
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3);   // c0 d0 c1 d1
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1);   // a2 b2 a3 b3
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);   // c2 d2 c3 d3
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + dstStride), _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * dstStride), _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * dstStride), _mm_unpackhi_epi64(t2, t3));
+}
+#endif
+
+} // namespace
+
+void transposeFrame(const FrameBuffer& source, FrameBuffer& destination, int rowBegin, int rowEnd)
+{
+    // destination(x, y) = source(y, x)
+    const Pixel* src = source.data();
+    Pixel* dst = destination.data();
+    std::ptrdiff_t srcStride = source.getWidth();
+    std::ptrdiff_t dstStride = destination.getWidth();
+    int dstWidth = destination.getWidth();
+
+    for (int by = rowBegin; by < rowEnd; by += transposeBlock) {
+        int blockRows = std::min(transposeBlock, rowEnd - by);
+
+        for (int bx = 0; bx < dstWidth; bx += transposeBlock) {
+            int blockCols = std::min(transposeBlock, dstWidth - bx);
+
+#if defined(__SSE2__)
+            if (blockRows == transposeBlock && blockCols == transposeBlock) {
+                for (int sy = 0; sy < transposeBlock; sy += 4) {
+                    for (int sx = 0; sx < transposeBlock; sx += 4) {
+                        transpose4x4(src + (bx + sy) * srcStride + by + sx, srcStride,
+                                     dst + (by + sx) * dstStride + bx + sy, dstStride);
+                    }
+                }
+                continue;
+            }
+#endif
+            // Edge blocks (and non-SSE2 targets)
+            for (int y = by; y < by + blockRows; y++) {
+                Pixel* dstRow = dst + y * dstStride;
+                for (int x = bx; x < bx + blockCols; x++) {
+                    dstRow[x] = src[x * srcStride + y];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+// FrameBuffer.hpp
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+// One packed pixel, stored in memory as R, G, B, A bytes - the layout
+// sf::Texture::update() takes, so a frame uploads without conversion.
+using Pixel = std::uint32_t;
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Pixel packing assumes a little-endian target");
+#endif
+
+inline Pixel packColor(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a = 255)
+{
+    return static_cast<Pixel>(r) | (static_cast<Pixel>(g) << 8) |
+           (static_cast<Pixel>(b) << 16) | (static_cast<Pixel>(a) << 24);
+}
+
+inline Pixel packColor(const sf::Color& color)
+{
+    return packColor(color.r, color.g, color.b, color.a);
+}
+
+inline std::uint8_t pixelRed(Pixel p)   { return static_cast<std::uint8_t>(p); }
+inline std::uint8_t pixelGreen(Pixel p) { return static_cast<std::uint8_t>(p >> 8); }
+inline std::uint8_t pixelBlue(Pixel p)  { return static_cast<std::uint8_t>(p >> 16); }
+inline std::uint8_t pixelAlpha(Pixel p) { return static_cast<std::uint8_t>(p >> 24); }
+
+inline sf::Color unpackColor(Pixel p)
+{
+    return sf::Color(pixelRed(p), pixelGreen(p), pixelBlue(p), pixelAlpha(p));
+}
+
+// Strided view of one screen column
+struct ColumnSpan {
+    Pixel* data;
+    std::ptrdiff_t stride;   // Distance in pixels between vertically adjacent pixels
+
+    Pixel& operator[](int y) const { return data[y * stride]; }
+};
+
+// Contiguous, cache-line aligned, row-major RGBA framebuffer.
+// Accessors are unchecked; callers clip to getWidth()/getHeight().
+class FrameBuffer {
+public:
+    static const std::size_t alignment = 64;
+
+    FrameBuffer(int width = 0, int height = 0);
+
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+    // Keeps the allocation when the new size fits in it, so a buffer that
+    // shrinks and grows back (dynamic resolution) never reallocates
+    void resize(int newWidth, int newHeight);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    std::size_t getPixelCount() const { return static_cast<std::size_t>(width) * height; }
+
+    Pixel* data() { return pixels.get(); }
+    const Pixel* data() const { return pixels.get(); }
+
+    // Raw RGBA bytes for sf::Texture::update
+    const std::uint8_t* bytes() const { return reinterpret_cast<const std::uint8_t*>(pixels.get()); }
+
+    Pixel* row(int y) { return pixels.get() + static_cast<std::size_t>(y) * width; }
+    const Pixel* row(int y) const { return pixels.get() + static_cast<std::size_t>(y) * width; }
+
+    ColumnSpan column(int x) { return ColumnSpan{pixels.get() + x, width}; }
+
+    Pixel& at(int x, int y) { return row(y)[x]; }
+    Pixel at(int x, int y) const { return row(y)[x]; }
+
+    void clear(Pixel color);
+    void copyFrom(const FrameBuffer& other);
+
+    // Fill a rectangle, clipped to the buffer
+    void fillRect(int x, int y, int w, int h, Pixel color);
+
+private:
+    struct AlignedDelete {
+        void operator()(Pixel* p) const { ::operator delete[](p, std::align_val_t(alignment)); }
+    };
+
+    int width;
+    int height;
+    std::size_t capacity;    // Pixels allocated
+    std::unique_ptr<Pixel[], AlignedDelete> pixels;
+};
+
+// Blocked transpose: writes destination rows [rowBegin, rowEnd) from the matching
+// source columns. destination must be source.getHeight() x source.getWidth().
+// Row bands are independent, so callers can split the range across threads.
+void transposeFrame(const FrameBuffer& source, FrameBuffer& destination, int rowBegin, int rowEnd);
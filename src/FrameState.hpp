@@ -0,0 +1,82 @@
+// FrameState.hpp
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include "RayTraversal.hpp"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Where a hit lies across its wall face, [0, 1], for texturing. wallX is the
+// hit's coordinate along the face: y on an x-side, x on a y-side. Faces seen
+// from +x or -y run the other way, so those flip to keep textures reading
+// left to right on every face.
+inline float faceTextureU(int side, float wallX, sf::Vector2f rayDir)
+{
+    float u = wallX - std::floor(wallX);
+    if ((side == 0 && rayDir.x > 0) || (side == 1 && rayDir.y < 0)) {
+        u = 1.0f - u;
+    }
+    return u;
+}
+
+// Per-column G-buffer filled by the visibility pass: one array per field, so
+// each shading pass streams only the fields it reads. Index x is screen column x.
+struct HitBuffer {
+    std::vector<float> distance;            // Perpendicular distance to the wall (the column's depth)
+    std::vector<std::uint8_t> side;         // 0 = x-side (EW face), 1 = y-side (NS face)
+    std::vector<std::uint8_t> wallType;
+    std::vector<std::int32_t> mapX, mapY;   // Wall cell
+    std::vector<float> textureU;            // Hit position across the wall face, [0, 1], left to right as seen
+    std::vector<std::int32_t> lineHeight;   // Wall slice height in pixels, Camera::lineHeight(distance)
+
+    int size() const { return static_cast<int>(distance.size()); }
+
+    void resize(int columns)
+    {
+        distance.resize(columns);
+        side.resize(columns);
+        wallType.resize(columns);
+        mapX.resize(columns);
+        mapY.resize(columns);
+        textureU.resize(columns);
+        lineHeight.resize(columns);
+    }
+
+    // Store one traced ray
+    void store(int x, const RayHit& hit, float u, int height)
+    {
+        distance[x] = hit.distance;
+        side[x] = static_cast<std::uint8_t>(hit.side);
+        wallType[x] = static_cast<std::uint8_t>(hit.wallType);
+        mapX[x] = hit.mapX;
+        mapY[x] = hit.mapY;
+        textureU[x] = u;
+        lineHeight[x] = height;
+    }
+};
+
+// A target sprite in front of the wall in at least one screen column.
+// Sprites are billboards: always facing the camera, sized by their depth.
+struct VisibleTarget {
+    int index;                      // Index into Map::getTargets()
+    float distance;                 // Camera-space depth, comparable with HitBuffer::distance
+    int lineHeight;                 // Slice height in pixels at that depth
+    int left, right;                // Screen columns [left, right) before clipping
+    int firstColumn, lastColumn;    // On-screen columns not hidden by a wall (inclusive)
+};
+
+// Result of the visibility pass for one frame: what every column's ray hit,
+// without any pixels. RayCaster::traceFrame fills it and RayCaster::renderFrame
+// shades from it.
+struct FrameState {
+    sf::Vector2f position;                      // Camera pose the rays were cast from
+    sf::Vector2f direction;
+    sf::Vector2f plane;
+    std::uint64_t mapRevision = 0;              // Map::getRevision() at trace time
+    int screenHeight = 0;                       // Render height the slice heights are for
+    bool reconstructed = false;                 // Interlaced: columns of the other parity are estimates
+    int tracedParity = 0;                       // Interlaced: parity of the columns last traced
+    bool dashing = false;                       // Player was dashing: tinted palette, no frame reuse
+    HitBuffer columnHits;                       // One entry per screen column
+    std::vector<VisibleTarget> visibleTargets;  // Far to near, the order they are drawn in
+};
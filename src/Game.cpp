@@ -1,7 +1,11 @@
 // Game.cpp
 #include "Game.hpp"
+#include "Profiler.hpp"
+#include "Simulation.hpp"
 #include <SFML/Window/Event.hpp>
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
  // add this to Game class
 
@@ -10,12 +14,16 @@
    player(),
    map(20, 20),
    raycaster(width, height),
+   input(std::make_unique<KeyboardInput>()),
+   playback(nullptr),
+   replayVerified(true),
+   stepCount(0),
+   accumulator(0.0f),
    isRunning(true),
+   presentPending(true),
    score(0)
 {
 // Reset targets to initial state
- window.setFramerateLimit(60);
-
  if (!textRenderer.initialize()) {
     // Handle font loading error
     std::cerr << "Failed to initialize text renderer" << std::endl;
@@ -37,16 +45,208 @@ textRenderer.createText("controls", "WASD: MOVE | ARROWS: TURN", "default", 16,
     sf::Color(255, 150, 0), sf::Vector2f(10, height - 30));
 }
 
+void Game::setWorld(std::unique_ptr<ChunkSource> source, sf::Vector2i start)
+{
+    world = std::make_unique<StreamingWorld>(std::move(source));
+    sf::Vector2f position = world->start(map, start);
+    player.setPose(position, player.getDirection(), player.getPlane());
+    previousPosition = position;
+}
+
+bool Game::startRecording(const std::string& path)
+{
+    if (world)
+    {
+        std::cerr << "Error: Streamed worlds load asynchronously and can't be recorded" << std::endl;
+        return false;
+    }
+    
+    ReplayHeader header = {};
+    header.checkpointInterval = 60;
+    header.stepSeconds = simulationStep;
+    header.startPosition[0] = player.getPosition().x;
+    header.startPosition[1] = player.getPosition().y;
+    header.startDirection[0] = player.getDirection().x;
+    header.startDirection[1] = player.getDirection().y;
+    header.startPlane[0] = player.getPlane().x;
+    header.startPlane[1] = player.getPlane().y;
+    header.mapHash = hashMapLayout(map);
+    header.startHash = hashSimulationState(player, map, score);
+    
+    auto log = std::make_unique<ReplayRecorder>();
+    if (!log->open(path, header)) return false;
+    recorder = std::move(log);
+    return true;
+}
+
+bool Game::startPlayback(const std::string& path)
+{
+    if (world)
+    {
+        std::cerr << "Error: Streamed worlds load asynchronously and can't be played back" << std::endl;
+        return false;
+    }
+    
+    auto replay = std::make_unique<ReplayInput>();
+    if (!replay->open(path)) return false;
+    
+    const ReplayHeader& header = replay->getHeader();
+    if (header.stepSeconds != simulationStep)
+    {
+        std::cerr << "Error: Replay " << path << " was recorded with " << header.stepSeconds
+                  << " s steps, this build steps " << simulationStep << " s" << std::endl;
+        return false;
+    }
+    if (header.mapHash != hashMapLayout(map))
+    {
+        std::cerr << "Error: Replay " << path << " was recorded on a different map" << std::endl;
+        return false;
+    }
+    
+    player.setPose(sf::Vector2f(header.startPosition[0], header.startPosition[1]),
+                   sf::Vector2f(header.startDirection[0], header.startDirection[1]),
+                   sf::Vector2f(header.startPlane[0], header.startPlane[1]));
+    if (header.startHash != hashSimulationState(player, map, score))
+    {
+        std::cerr << "Error: Replay " << path << " starts from a different game state" << std::endl;
+        return false;
+    }
+    
+    playback = replay.get();
+    input = std::move(replay);
+    return true;
+}
+
 void Game::run()
 {
     while (isRunning && window.isOpen())
     {
+        PROFILE_BEGIN_FRAME();
         handleInput();
         
-        float deltaTime = clock.restart().asSeconds();
-        update(deltaTime);
+        float frameTime = std::min(clock.restart().asSeconds(), maxFrameTime);
+        accumulator += frameTime;
         
-        render();
+        // Run as many fixed steps as real time allows
+        int steps = 0;
+        {
+            PROFILE_SCOPE(Simulate);
+            while (isRunning && accumulator >= simulationStep && steps < maxStepsPerFrame)
+            {
+                previousPosition = player.getPosition();
+                previousDirection = player.getDirection();
+                previousPlane = player.getPlane();
+                
+                update(simulationStep);
+                accumulator -= simulationStep;
+                steps++;
+            }
+        }
+        
+        // Too far behind: drop the backlog instead of slowing down further
+        if (steps == maxStepsPerFrame)
+        {
+            accumulator = std::fmod(accumulator, simulationStep);
+        }
+        
+        // Keep the streamed window around the player. A window move shifts
+        // map coordinates, so both poses used for interpolation move with it.
+        if (world)
+        {
+            PROFILE_SCOPE(Stream);
+            sf::Vector2i shift = world->update(map, player.getPosition());
+            if (shift != sf::Vector2i())
+            {
+                sf::Vector2f offset(static_cast<float>(shift.x), static_cast<float>(shift.y));
+                player.setPose(player.getPosition() - offset, player.getDirection(), player.getPlane());
+                previousPosition -= offset;
+            }
+        }
+        
+        // Draw the pose between the last two steps, so motion stays smooth at any frame rate
+        Player view = interpolatedPlayer(accumulator / simulationStep);
+        renderClock.restart();
+        raycaster.traceFrame(view, map, frameState);
+        
+        render(view, frameTime);
+        PROFILE_END_FRAME();
+    }
+    
+    if (recorder)
+    {
+        if (recorder->close(hashSimulationState(player, map, score)))
+        {
+            std::cout << "Recorded " << recorder->getStepCount() << " steps" << std::endl;
+        }
+        recorder.reset();
+    }
+}
+
+Player Game::interpolatedPlayer(float alpha) const
+{
+    Player view = player;
+    if (previousDirection == sf::Vector2f())
+    {
+        return view;  // No step taken yet
+    }
+    
+    sf::Vector2f position = previousPosition + (player.getPosition() - previousPosition) * alpha;
+    sf::Vector2f direction = previousDirection + (player.getDirection() - previousDirection) * alpha;
+    sf::Vector2f plane = previousPlane + (player.getPlane() - previousPlane) * alpha;
+    
+    // Lerped rotations are slightly short; restore the original lengths
+    float directionLength = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    float planeLength = std::sqrt(plane.x * plane.x + plane.y * plane.y);
+    sf::Vector2f currentPlane = player.getPlane();
+    float targetPlaneLength = std::sqrt(currentPlane.x * currentPlane.x + currentPlane.y * currentPlane.y);
+    if (directionLength > 0.0f && planeLength > 0.0f)
+    {
+        direction /= directionLength;
+        plane *= targetPlaneLength / planeLength;
+    }
+    
+    view.setPose(position, direction, plane);
+    return view;
+}
+
+void Game::setFrameBudget(float budget, float minScale)
+{
+    sf::Vector2i output = raycaster.getOutputSize();
+    if (budget <= 0.0f)
+    {
+        if (resolution)
+        {
+            resolution.reset();
+            raycaster.setRenderResolution(output.x, output.y);
+            textRenderer.updateText("resolution", "");
+        }
+        return;
+    }
+    
+    ResolutionController::Settings settings;
+    settings.targetFrameTime = budget;
+    settings.minScale = minScale;
+    resolution = std::make_unique<ResolutionController>(settings);
+    raycaster.setRenderResolution(output.x, output.y);
+    
+    textRenderer.createText("resolution", resolution->getStatsText(), "default", 16,
+        sf::Color(170, 230, 255), sf::Vector2f(output.x - 230, 10));
+}
+
+void Game::adjustResolution(float renderTime)
+{
+    if (!resolution) return;
+    
+    if (resolution->addFrame(renderTime))
+    {
+        sf::Vector2i output = raycaster.getOutputSize();
+        raycaster.setRenderResolution(resolution->scaledSize(output.x), resolution->scaledSize(output.y));
+    }
+    
+    // The readout changes once per averaging window
+    if (resolution->getStats().frames % resolution->getSettings().windowFrames == 0)
+    {
+        textRenderer.updateText("resolution", resolution->getStatsText());
     }
 }
 
@@ -59,56 +259,102 @@ void Game::handleInput()
             window.close();
             isRunning = false;
         }
+        else if (event->is<sf::Event::Resized>() || event->is<sf::Event::FocusGained>())
+        {
+            // The window contents may be lost; draw it again
+            presentPending = true;
+        }
+        else if (const auto* key = event->getIf<sf::Event::KeyPressed>())
+        {
+            // F3 toggles the frame time graph
+            if (key->code == sf::Keyboard::Key::F3)
+            {
+                setProfileOverlay(!raycaster.isProfileOverlayEnabled());
+            }
+        }
     }
-
-    
-    // Pass keyboard state to player
-    sf::Keyboard::Key pressedKeys[] = {
-        sf::Keyboard::Key::W, sf::Keyboard::Key::A,
-        sf::Keyboard::Key::S, sf::Keyboard::Key::D,
-        sf::Keyboard::Key::Left, sf::Keyboard::Key::Right,
-        sf::Keyboard::Key::LShift, sf::Keyboard::Key::RShift
-    };
-    player.handleInput(clock.getElapsedTime().asSeconds(), pressedKeys, map);
 }
 
 void Game::update(float deltaTime)
 {
+    InputState stepInput;
+    if (!input->next(stepInput))
+    {
+        // The replay is over
+        std::cout << "Replay finished after " << stepCount << " steps, matching its recording" << std::endl;
+        isRunning = false;
+        return;
+    }
+    
+    int points = stepSimulation(player, map, stepInput, deltaTime);
+    stepCount++;
+    if (points > 0)
+    {
+        updateScore(points);
+    }
+    
+    checkReplay(stepInput);
+}
 
-std::cout << "Current score: " << score << std::endl;
+void Game::checkReplay(const InputState& stepInput)
+{
+    if (recorder)
+    {
+        recorder->record(stepInput);
+        if (recorder->isCheckpointDue())
+        {
+            recorder->checkpoint(hashSimulationState(player, map, score));
+        }
+    }
+    
+    // Stop at the first divergence; every later state differs too
+    if (playback && playback->hasCheckpoint(stepCount) &&
+        !playback->verify(stepCount, hashSimulationState(player, map, score)))
+    {
+        replayVerified = false;
+        isRunning = false;
+    }
+}
 
-    player.update(deltaTime);
+void Game::updateScore(int points)
+{
+    score += points;
+    textRenderer.updateText("score", "SCORE: " + std::to_string(score));
+}
 
-    player.update(deltaTime);
-    
-    // Cast rays and get scene information
-    raycaster.castRays(player, map);
+void Game::setProfileOverlay(bool enabled)
+{
+    raycaster.setProfileOverlay(enabled);
     
-    // Check for target hits and update score
-    const auto& hitTargets = raycaster.getHitTargets();
-    for (const auto& target : hitTargets) {
-        if (target.isNewHit) {
-            // Mark target as hit in the map
-            map.hitTarget(target.x, target.y);
-            
-            // Increment score
-            score += target.points;
-            
-            // Update score display
-            textRenderer.updateText("score", "SCORE: " + std::to_string(score));
-        }
+    // The graph needs timings even when no trace was asked for
+    if (enabled)
+    {
+        Profiler::instance().setEnabled(true);
     }
 }
 
-void Game::render()
+void Game::render(const Player& view, float frameTime)
 {
-    window.clear(sf::Color::Black);
+    // Shade the view traced this frame
+    raycaster.renderFrame(frameState, view, map, frameTime);
+    adjustResolution(renderClock.getElapsedTime().asSeconds());
     
-    // Cast rays and render the view
-    raycaster.castRays(player, map);
+    // Nothing on screen changed (idle player, animation between color steps):
+    // keep showing the last frame and sleep until the next simulation step
+    if (!raycaster.hasFrameChanged() && !presentPending)
+    {
+        sf::sleep(sf::seconds(simulationStep - accumulator));
+        return;
+    }
+    presentPending = false;
     
+    window.clear(sf::Color::Black);
     raycaster.draw(window);
-    textRenderer.draw(window);
+    {
+        PROFILE_SCOPE(Text);
+        textRenderer.draw(window);
+    }
     
+    PROFILE_SCOPE(Present);
     window.display();
 }
@@ -3,7 +3,12 @@
 #include "Player.hpp"
 #include "Map.hpp"
 #include "RayCaster.hpp"
+#include "StreamingWorld.hpp"
+#include "ResolutionController.hpp"
+#include "Input.hpp"
+#include "Replay.hpp"
 #include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
 #include "TextRenderer.hpp"
 
 class Game {
@@ -11,31 +16,88 @@ private:
     sf::RenderWindow window;      // The SFML window for rendering
     Player player;                // Player object that handles movement and camera
     Map map;                      // Map object containing the level grid
+    std::unique_ptr<StreamingWorld> world;  // Streams a larger world through map, if set
     RayCaster raycaster;          // RayCaster object for rendering the 3D view
+    FrameState frameState;        // Visibility traced by update, drawn by render
+    std::unique_ptr<InputSource> input;        // Where each step's input comes from
+    std::unique_ptr<ReplayRecorder> recorder;  // Logs every step's input, if set
+    ReplayInput* playback;        // input, when it plays a replay back
+    bool replayVerified;          // No playback checkpoint has mismatched
+    std::uint64_t stepCount;      // Simulation steps since the start
+    std::unique_ptr<ResolutionController> resolution;  // Scales the render resolution to a budget, if set
+    sf::Clock renderClock;        // Restarted before each trace, read once the frame is shaded
     sf::Clock clock;              // Clock for timing and delta time calculation
+    float accumulator;            // Real time not yet consumed by simulation steps
+    sf::Vector2f previousPosition;    // Player pose before the latest step, for interpolation
+    sf::Vector2f previousDirection;
+    sf::Vector2f previousPlane;
     bool isRunning;               // Flag to control the game loop
+    bool presentPending;          // Window needs a redraw even if the frame is unchanged
     sf::Clock targetRespawnClock; 
     int score;                    // Player's score
     TextRenderer textRenderer;    // Text rendering system for UI elements
 
+    // The simulation always advances in fixed steps, independent of frame rate
+    static constexpr float simulationStep = 1.0f / 60.0f;
+    static constexpr float maxFrameTime = 0.25f;  // Longer stalls (debugger, window drag) are dropped
+    static constexpr int maxStepsPerFrame = 8;    // Catch-up cap so slow frames can't spiral
+
+    // Player pose blended between the last two steps; alpha in [0, 1]
+    Player interpolatedPlayer(float alpha) const;
+
+    // Log the step to the recording, and record or check the state hash
+    // at replay checkpoints
+    void checkReplay(const InputState& stepInput);
+
+    // Feed the frame's render time to the resolution controller and apply its scale
+    void adjustResolution(float renderTime);
+
 public:
     // Constructor initializes the game with window dimensions and title
     Game(int width, int height, const std::string& title);
     
+    // Play in a streamed world instead of the built-in map, starting near
+    // world cell start
+    void setWorld(std::unique_ptr<ChunkSource> source, sf::Vector2i start);
+    
+    // Lower the render resolution (to at least minScale of the window, per
+    // axis) when tracing and shading a frame takes longer than budget
+    // seconds; 0 turns it off. Shows the current scale and frame time.
+    void setFrameBudget(float budget, float minScale = 0.5f);
+    
+    // Trace alternate columns each frame and estimate the rest (RayCaster::setInterlaced)
+    void setInterlaced(bool enabled) { raycaster.setInterlaced(enabled); }
+    
+    // Log every step's input to path (a .rcreplay) for playback. Call before
+    // run; not for streamed worlds. Prints why on failure.
+    bool startRecording(const std::string& path);
+    
+    // Take input from a replay log instead of the keyboard, checking the
+    // recorded state hashes on the way; the game stops at its end. Call
+    // before run. Prints why on failure.
+    bool startPlayback(const std::string& path);
+    
+    // False once a played back replay has diverged from its recording
+    bool isReplayVerified() const { return replayVerified; }
+    
     // Main game loop
     void run();
     
-    // Process input events from keyboard/mouse
+    // Process window events
     void handleInput();
     
-    // Update game state (player position, etc.) based on elapsed time
+    // Advance the simulation (input, player, dash hits) by one fixed step
     void update(float deltaTime);
     
+    // Add points to the score and its display
     void updateScore(int points);
     
     // Update UI elements
     void updateUI();
     
-    // Render the current frame
-    void render();
+    // Show the stage timing graph over the frame (also toggled with F3)
+    void setProfileOverlay(bool enabled);
+    
+    // Render the current frame from an interpolated view; frameTime is real seconds
+    void render(const Player& view, float frameTime);
 };
@@ -0,0 +1,18 @@
+// Input.cpp
+#include "Input.hpp"
+#include <SFML/Window/Keyboard.hpp>
+
+bool KeyboardInput::next(InputState& input)
+{
+    using Key = sf::Keyboard::Key;
+    input = InputState();
+    input.setDown(InputForward, sf::Keyboard::isKeyPressed(Key::W));
+    input.setDown(InputBackward, sf::Keyboard::isKeyPressed(Key::S));
+    input.setDown(InputStrafeLeft, sf::Keyboard::isKeyPressed(Key::A));
+    input.setDown(InputStrafeRight, sf::Keyboard::isKeyPressed(Key::D));
+    input.setDown(InputTurnLeft, sf::Keyboard::isKeyPressed(Key::Left));
+    input.setDown(InputTurnRight, sf::Keyboard::isKeyPressed(Key::Right));
+    input.setDown(InputDash, sf::Keyboard::isKeyPressed(Key::LShift) ||
+                             sf::Keyboard::isKeyPressed(Key::RShift));
+    return true;
+}
@@ -0,0 +1,42 @@
+// Input.hpp
+#pragma once
+#include <cstdint>
+
+// What the player asks for in one simulation step. Everything the
+// simulation reads from the keyboard goes through here, so a step is a
+// function of its input and can be recorded and replayed.
+enum InputButton : std::uint8_t {
+    InputForward     = 1 << 0,
+    InputBackward    = 1 << 1,
+    InputStrafeLeft  = 1 << 2,
+    InputStrafeRight = 1 << 3,
+    InputTurnLeft    = 1 << 4,
+    InputTurnRight   = 1 << 5,
+    InputDash        = 1 << 6,
+};
+
+struct InputState {
+    std::uint8_t buttons = 0;   // InputButton bits held down
+
+    bool isDown(InputButton button) const { return (buttons & button) != 0; }
+    void setDown(InputButton button, bool down)
+    {
+        buttons = static_cast<std::uint8_t>(down ? buttons | button : buttons & ~button);
+    }
+};
+
+// Where the game takes each step's input from
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    // Input for the next step. False when there is none left (the end of a
+    // replay); input is then left empty.
+    virtual bool next(InputState& input) = 0;
+};
+
+// The live keyboard: WASD to move and strafe, arrows to turn, either Shift to dash
+class KeyboardInput : public InputSource {
+public:
+    bool next(InputState& input) override;
+};
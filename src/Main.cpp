@@ -1,15 +1,110 @@
 #include <SFML/Graphics.hpp>
 #include "Game.hpp"
+#include "Profiler.hpp"
+#include "StreamingWorld.hpp"
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string>
 
-int main() {
+static void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [--profile-trace FILE] [--profile-csv FILE] [--profile-overlay]" << std::endl
+              << "       [--world FILE.rcmap | --procedural SEED] [--frame-budget MS] [--interlace]" << std::endl
+              << "       [--record FILE.rcreplay | --replay FILE.rcreplay]" << std::endl
+              << "--profile-trace writes per-stage timings as Chrome trace JSON on exit" << std::endl
+              << "                (open in chrome://tracing or ui.perfetto.dev)." << std::endl
+              << "--profile-csv writes the same events as CSV." << std::endl
+              << "--profile-overlay starts with the frame time graph shown (F3 toggles it)." << std::endl
+              << "Stage timings are only recorded when built with RAYCASTER_PROFILING." << std::endl
+              << "--world streams a binary map in chunks instead of loading it whole." << std::endl
+              << "--procedural plays an endless generated world." << std::endl
+              << "--frame-budget lowers the render resolution (down to half) while frames" << std::endl
+              << "               take longer than MS milliseconds to render." << std::endl
+              << "--interlace traces every other column per frame and estimates the rest" << std::endl
+              << "            from the last frame." << std::endl
+              << "--record logs every simulation step's input, with state hashes to check" << std::endl
+              << "         a playback against." << std::endl
+              << "--replay plays a recorded log back instead of the keyboard and stops at" << std::endl
+              << "         its end; exits with an error if the game diverges from it." << std::endl
+              << "Streamed worlds (--world, --procedural) can't be recorded or played back." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string tracePath;
+    std::string csvPath;
+    bool showOverlay = false;
+    std::string worldPath;
+    long long worldSeed = -1;
+    float frameBudgetMs = 0.0f;
+    bool interlace = false;
+    std::string recordPath;
+    std::string replayPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--profile-trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--profile-csv" && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (arg == "--profile-overlay") {
+            showOverlay = true;
+        } else if (arg == "--world" && i + 1 < argc) {
+            worldPath = argv[++i];
+        } else if (arg == "--procedural" && i + 1 < argc) {
+            worldSeed = std::strtoll(argv[++i], nullptr, 10) & 0xffffffff;
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--interlace") {
+            interlace = true;
+        } else if (arg == "--frame-budget" && i + 1 < argc) {
+            frameBudgetMs = std::strtof(argv[++i], nullptr);
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (!recordPath.empty() && !replayPath.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    bool profiling = !tracePath.empty() || !csvPath.empty() || showOverlay;
+    if (profiling && !RAYCASTER_PROFILING) {
+        std::cerr << "Built without RAYCASTER_PROFILING; no stage timings will be recorded" << std::endl;
+    }
+    Profiler::instance().setEnabled(profiling);
+
+    bool replayVerified = true;
     try {
         // Create the game with window dimensions and title
         Game game(800, 600, "Raycasting Game");
-        
-        
+        game.setProfileOverlay(showOverlay);
+        game.setInterlaced(interlace);
+        if (frameBudgetMs > 0.0f) game.setFrameBudget(frameBudgetMs / 1000.0f);
+
+        // Streamed worlds start in the middle of the map file, or of chunk (0, 0)
+        if (!worldPath.empty()) {
+            auto source = std::make_unique<MapFileChunkSource>();
+            if (!source->open(worldPath)) return 1;
+            sf::Vector2i start(source->getWidth() / 2, source->getHeight() / 2);
+            game.setWorld(std::move(source), start);
+        } else if (worldSeed >= 0) {
+            int middle = StreamingWorld::chunkSize / 2;
+            game.setWorld(std::make_unique<ProceduralChunkSource>(static_cast<std::uint32_t>(worldSeed)),
+                          sf::Vector2i(middle, middle));
+        }
+
+        // Replays start from the built-in map
+        if (!recordPath.empty() && !game.startRecording(recordPath)) return 1;
+        if (!replayPath.empty() && !game.startPlayback(replayPath)) return 1;
+
         // Run the game
         game.run();
+        replayVerified = game.isReplayVerified();
     }
     catch (const std::exception& e) {
         // Catch and log any exceptions that might occur
@@ -22,5 +117,10 @@ int main() {
         return -1;
     }
 
-    return 0;
+    // The ring keeps the most recent frames
+    bool written = true;
+    if (!tracePath.empty()) written = Profiler::instance().writeChromeTrace(tracePath) && written;
+    if (!csvPath.empty()) written = Profiler::instance().writeCsv(csvPath) && written;
+
+    return written && replayVerified ? 0 : -1;
 }
@@ -1,49 +1,87 @@
 // Map.cpp
 #include "Map.hpp"
+#include "MapFile.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+
+namespace {
+
+std::atomic<std::uint64_t> nextRevision{1};
+
+// Next integer in [p, end), skipping whitespace; false at the end or on anything else
+bool parseInt(const char*& p, const char* end, int& value)
+{
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+
+    bool negative = p < end && *p == '-';
+    if (negative) p++;
+    if (p >= end || *p < '0' || *p > '9') return false;
+
+    long long result = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = std::min(result * 10 + (*p - '0'), 1LL << 40);
+        p++;
+    }
+    result = negative ? -result : result;
+    value = static_cast<int>(std::max<long long>(INT32_MIN, std::min<long long>(INT32_MAX, result)));
+    return true;
+}
+
+// Pad the write position up to the next section
+void padTo(std::ofstream& file, std::uint64_t offset)
+{
+    static const char zeros[mapFileAlignment] = {};
+    std::uint64_t position = static_cast<std::uint64_t>(file.tellp());
+    if (offset > position) file.write(zeros, static_cast<std::streamsize>(offset - position));
+}
+
+} // namespace
 
 Map::Map(int width, int height)
-    : width(width), height(height) {
+    : width(0), height(0), stride(0), cells(nullptr), revision(0) {
     // Initialize with a simple maze-like structure
-    grid.resize(height, std::vector<int>(width, 0));
+    allocateCells(width, height);
     targets.clear(); // Initialize empty targets vector
     
     // Create walls around the map edges
     for (int x = 0; x < width; x++)
     {
-        grid[0][x] = 1;
-        grid[height - 1][x] = 1;
+        setValueAt(x, 0, 1);
+        setValueAt(x, height - 1, 1);
     }
     
     for (int y = 0; y < height; y++)
     {
-        grid[y][0] = 1;
-        grid[y][width - 1] = 1;
+        setValueAt(0, y, 1);
+        setValueAt(width - 1, y, 1);
     }
     
     // Add some walls in the middle
     for (int x = 7; x < 12; x++)
     {
-        grid[7][x] = 1;
+        setValueAt(x, 7, 1);
     }
     
     for (int y = 12; y < 16; y++)
     {
-        grid[y][12] = 1;
+        setValueAt(12, y, 1);
     }
     
     // Add a pillar
-    grid[5][5] = 1;
+    setValueAt(5, 5, 1);
     
     // Add some different wall types (represented by different integers)
-    grid[10][5] = 2;
-    grid[11][5] = 2;
-    grid[12][5] = 2;
+    setValueAt(5, 10, 2);
+    setValueAt(5, 11, 2);
+    setValueAt(5, 12, 2);
     
-    grid[5][10] = 3;
-    grid[5][11] = 3;
-    grid[5][12] = 3;
+    setValueAt(10, 5, 3);
+    setValueAt(11, 5, 3);
+    setValueAt(12, 5, 3);
 
     // Add some default targets to the practice range
     addTarget(8, 3, 10);  // x, y, points
@@ -51,46 +89,155 @@ Map::Map(int width, int height)
     addTarget(10, 15, 30);
 }
 
-void Map::loadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
+bool Map::loadFromFile(const std::string& filename) {
+    // Binary files start with the magic; anything else is read as text
+    MappedFile file;
+    if (!file.open(filename)) return false;
+    if (file.size() >= sizeof(mapFileMagic) && std::memcmp(file.data(), mapFileMagic, sizeof(mapFileMagic)) == 0) {
+        return loadBinary(std::move(file), filename);
+    }
+    file.close();
+    return loadText(filename);
+}
+
+// Text format: height and width, height rows of width cell values, then
+// optionally a target count and "x y points" per target
+bool Map::loadText(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
     if (!file.is_open())
     {
         std::cerr << "Error: Could not open map file " << filename << std::endl;
-        return;
+        return false;
     }
-    
-    file >> height >> width;
-    grid.resize(height, std::vector<int>(width, 0));
-    
-    for (int y = 0; y < height; y++)
+
+    // One read, then parse in memory: much faster than operator>> per value
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const char* p = text.data();
+    const char* end = p + text.size();
+
+    int newHeight = 0, newWidth = 0;
+    if (!parseInt(p, end, newHeight) || !parseInt(p, end, newWidth) ||
+        newWidth <= 0 || newHeight <= 0 || newWidth > MAX_SIZE || newHeight > MAX_SIZE)
     {
-        for (int x = 0; x < width; x++)
+        std::cerr << "Error: Map file " << filename << " has no valid size" << std::endl;
+        return false;
+    }
+
+    // Fill a fresh grid, so nothing of the old map survives the load
+    std::vector<std::uint8_t> newCells;
+    int newStride = newWidth + 2 * PADDING;
+    newCells.assign(static_cast<std::size_t>(newStride) * (newHeight + 2 * PADDING) + 3, STANDARD_WALL);
+    for (int y = 0; y < newHeight; y++)
+    {
+        std::uint8_t* row = newCells.data() + static_cast<std::size_t>(y + PADDING) * newStride + PADDING;
+        for (int x = 0; x < newWidth; x++)
         {
-            file >> grid[y][x];
+            int value = 0;
+            if (!parseInt(p, end, value))
+            {
+                std::cerr << "Error: Map file " << filename << " ends before cell (" << x << ", " << y << ")" << std::endl;
+                return false;
+            }
+            row[x] = static_cast<std::uint8_t>(std::min(255, std::max(0, value)));
         }
     }
-    
+
     // Load targets if they exist in the file
-    int numTargets;
-    if (file >> numTargets) {
-        targets.clear();
+    std::vector<Target> newTargets;
+    int numTargets = 0;
+    if (parseInt(p, end, numTargets)) {
         for (int i = 0; i < numTargets; i++) {
             int x, y, points;
-            if (file >> x >> y >> points) {
-                addTarget(x, y, points);
+            if (!parseInt(p, end, x) || !parseInt(p, end, y) || !parseInt(p, end, points)) break;
+            newTargets.push_back(Target{x, y, points, false});
+        }
+    }
+
+    width = newWidth;
+    height = newHeight;
+    stride = newStride;
+    ownedCells = std::move(newCells);
+    mappedFile.close();
+    cells = ownedCells.data();
+
+    targets.clear();
+    targetIndex.clear();
+    resetOccupancy();
+    for (const Target& target : newTargets) {
+        addTarget(target.x, target.y, target.points);
+    }
+    touch();
+    return true;
+}
+
+bool Map::loadBinary(MappedFile file, const std::string& filename) {
+    MapFileHeader header;
+    if (!readMapFileHeader(file, filename, header)) return false;
+    if (header.width > MAX_SIZE || header.height > MAX_SIZE || header.padding != PADDING)
+    {
+        std::cerr << "Error: Map file " << filename << " has an unsupported size or padding" << std::endl;
+        return false;
+    }
+    int newStride = header.width + 2 * PADDING;
+
+    // Rays rely on the solid border to stop; check it rather than trust it
+    std::uint8_t* grid = file.data() + header.cellsOffset;
+    int paddedHeight = header.height + 2 * PADDING;
+    for (int y = 0; y < paddedHeight; y++)
+    {
+        const std::uint8_t* row = grid + static_cast<std::size_t>(y) * newStride;
+        bool edgeRow = y < PADDING || y >= paddedHeight - PADDING;
+        for (int x = 0; x < newStride; x++)
+        {
+            if (!edgeRow && x == PADDING) x += header.width;  // Skip the interior
+            if (row[x] != STANDARD_WALL)
+            {
+                std::cerr << "Error: Map file " << filename << " has an open border" << std::endl;
+                return false;
             }
         }
     }
-    
-    file.close();
+
+    width = header.width;
+    height = header.height;
+    stride = newStride;
+    mappedFile = std::move(file);
+    cells = grid;
+    std::vector<std::uint8_t>().swap(ownedCells);
+
+    targets.clear();
+    targetIndex.clear();
+    targetIndex.reserve(static_cast<std::size_t>(header.targetCount));
+    int skipped = 0;
+    const std::uint8_t* records = mappedFile.data() + header.targetsOffset;
+    for (std::uint64_t i = 0; i < header.targetCount; i++) {
+        MapFileTarget record;
+        std::memcpy(&record, records + i * sizeof(record), sizeof(record));
+
+        // Same rules as addTarget
+        if (record.x < 0 || record.x >= width || record.y < 0 || record.y >= height ||
+            isWall(record.x, record.y) || findTarget(cellOffset(record.x, record.y)) != NO_TARGET) {
+            skipped++;
+            continue;
+        }
+        targetIndex[cellOffset(record.x, record.y)] = static_cast<int>(targets.size());
+        targets.push_back(Target{record.x, record.y, record.points, (record.flags & mapFileTargetHit) != 0});
+    }
+    if (skipped > 0) {
+        std::cerr << "Warning: Map file " << filename << ": skipped " << skipped << " invalid targets" << std::endl;
+    }
+
+    resetOccupancy();
+    touch();
+    return true;
 }
 
-void Map::saveToFile(const std::string& filename) const {
+bool Map::saveToFile(const std::string& filename) const {
     std::ofstream file(filename);
     if (!file.is_open())
     {
         std::cerr << "Error: Could not open map file for writing " << filename << std::endl;
-        return;
+        return false;
     }
     
     file << height << " " << width << std::endl;
@@ -99,7 +246,7 @@ void Map::saveToFile(const std::string& filename) const {
     {
         for (int x = 0; x < width; x++)
         {
-            file << grid[y][x] << " ";
+            file << getValueAt(x, y) << " ";
         }
         file << std::endl;
     }
@@ -110,17 +257,130 @@ void Map::saveToFile(const std::string& filename) const {
         file << target.x << " " << target.y << " " << target.points << std::endl;
     }
     
-    file.close();
+    return static_cast<bool>(file);
+}
+
+bool Map::saveToBinaryFile(const std::string& filename, int chunkSize) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Could not open map file for writing " << filename << std::endl;
+        return false;
+    }
+
+    // Target order: as in memory, or grouped by chunk (stable) with an index
+    chunkSize = std::max(0, chunkSize);
+    int chunksX = chunkSize > 0 ? (width + chunkSize - 1) / chunkSize : 0;
+    int chunksY = chunkSize > 0 ? (height + chunkSize - 1) / chunkSize : 0;
+    std::vector<MapFileChunk> chunks(static_cast<std::size_t>(chunksX) * chunksY, MapFileChunk{0, 0, 0, 0});
+    auto chunkOf = [&](int x, int y) { return (y / chunkSize) * chunksX + x / chunkSize; };
+
+    std::vector<int> order(targets.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<int>(i);
+    if (chunkSize > 0) {
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return chunkOf(targets[a].x, targets[a].y) < chunkOf(targets[b].x, targets[b].y);
+        });
+        for (size_t i = 0; i < order.size(); i++) {
+            MapFileChunk& chunk = chunks[chunkOf(targets[order[i]].x, targets[order[i]].y)];
+            if (chunk.targetCount == 0) chunk.firstTarget = static_cast<std::uint32_t>(i);
+            chunk.targetCount++;
+        }
+        for (int y = 0; y < height; y++) {
+            const std::uint8_t* row = cells + cellOffset(0, y);
+            for (int x = 0; x < width; x++) {
+                if (row[x] != EMPTY) chunks[chunkOf(x, y)].wallCells++;
+            }
+        }
+    }
+
+    std::uint64_t gridBytes = static_cast<std::uint64_t>(stride) * (height + 2 * PADDING) + 3;
+
+    MapFileHeader header = {};
+    std::memcpy(header.magic, mapFileMagic, sizeof(header.magic));
+    header.version = mapFileVersion;
+    header.headerSize = sizeof(header);
+    header.width = width;
+    header.height = height;
+    header.padding = PADDING;
+    header.chunkSize = static_cast<std::uint32_t>(chunkSize);
+    header.cellsOffset = alignMapFileOffset(sizeof(header));
+    header.targetsOffset = alignMapFileOffset(header.cellsOffset + gridBytes);
+    header.targetCount = targets.size();
+    header.chunksOffset = chunkSize > 0 ? alignMapFileOffset(header.targetsOffset + targets.size() * sizeof(MapFileTarget)) : 0;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    padTo(file, header.cellsOffset);
+    file.write(reinterpret_cast<const char*>(cells), static_cast<std::streamsize>(gridBytes));
+
+    padTo(file, header.targetsOffset);
+    for (int index : order) {
+        const Target& target = targets[index];
+        MapFileTarget record = {target.x, target.y, target.points, target.hit ? mapFileTargetHit : 0u};
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    if (chunkSize > 0) {
+        padTo(file, header.chunksOffset);
+        file.write(reinterpret_cast<const char*>(chunks.data()),
+                   static_cast<std::streamsize>(chunks.size() * sizeof(MapFileChunk)));
+    }
+
+    if (!file)
+    {
+        std::cerr << "Error: Failed writing map file " << filename << std::endl;
+        return false;
+    }
+    return true;
 }
 
 int Map::getValueAt(int x, int y) const {
     if (x >= 0 && x < width && y >= 0 && y < height)
     {
-        return grid[y][x];
+        return cells[cellOffset(x, y)];
     }
     return -1;  // Out of bounds
 }
 
+void Map::setValueAt(int x, int y, int value) {
+    if (x >= 0 && x < width && y >= 0 && y < height)
+    {
+        std::uint8_t cell = static_cast<std::uint8_t>(std::min(255, std::max(0, value)));
+        int offset = cellOffset(x, y);
+        if (cells[offset] != cell)
+        {
+            bool wasOccupied = isOccupied(offset);
+            cells[offset] = cell;
+            occupancyChanged(x, y, wasOccupied);
+            touch();
+        }
+    }
+}
+
+void Map::touch() {
+    revision = nextRevision.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Map::allocateCells(int newWidth, int newHeight) {
+    width = std::max(0, newWidth);
+    height = std::max(0, newHeight);
+    stride = width + 2 * PADDING;
+
+    // Everything starts as padding wall, then the interior is cleared.
+    // 3 spare bytes let SIMD code load any cell as a 32-bit word.
+    std::size_t paddedCells = static_cast<std::size_t>(stride) * (height + 2 * PADDING);
+    ownedCells.assign(paddedCells + 3, STANDARD_WALL);
+    mappedFile.close();
+    cells = ownedCells.data();
+    for (int y = 0; y < height; y++)
+    {
+        std::fill_n(cells + cellOffset(0, y), width, EMPTY);
+    }
+    targetIndex.clear();
+    resetOccupancy();
+    touch();
+}
+
 bool Map::isWall(int x, int y) const {
     int value = getValueAt(x, y);
     return value > 0;  // Anything greater than 0 is a wall
@@ -135,21 +395,78 @@ int Map::getHeight() const {
 }
 
 // Target-related methods
+void Map::rebuildTargetIndex() {
+    targetIndex.clear();
+    for (size_t i = 0; i < targets.size(); i++) {
+        const Target& target = targets[i];
+        if (target.x >= 0 && target.x < width && target.y >= 0 && target.y < height) {
+            targetIndex[cellOffset(target.x, target.y)] = static_cast<int>(i);
+        }
+    }
+    touch();
+}
+
+int Map::getTargetIndex(int x, int y) const {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        return findTarget(cellOffset(x, y));
+    }
+    return NO_TARGET;
+}
+
+int Map::findTarget(int offset) const {
+    auto it = targetIndex.find(offset);
+    return it != targetIndex.end() ? it->second : NO_TARGET;
+}
+
+void Map::findTargetsIn(int left, int top, int right, int bottom, std::vector<int>& indices) const {
+    indices.clear();
+    if (targetIndex.empty()) return;
+
+    // Probe the block's cells or scan the target list, whichever is shorter
+    std::size_t area = static_cast<std::size_t>(right - left) * (bottom - top);
+    if (area <= targets.size()) {
+        for (int row = top; row < bottom; row++) {
+            for (int column = left; column < right; column++) {
+                int index = findTarget(cellOffset(column, row));
+                if (index != NO_TARGET) indices.push_back(index);
+            }
+        }
+        return;
+    }
+    for (size_t i = 0; i < targets.size(); i++) {
+        const Target& target = targets[i];
+        if (target.x >= left && target.x < right && target.y >= top && target.y < bottom) {
+            indices.push_back(static_cast<int>(i));
+        }
+    }
+    std::sort(indices.begin(), indices.end(), [this](int a, int b) {
+        return targets[a].y != targets[b].y ? targets[a].y < targets[b].y : targets[a].x < targets[b].x;
+    });
+}
+
 void Map::addTarget(int x, int y, int points) {
-    // Only add target if position is valid (not a wall and within bounds)
-    if (x >= 0 && x < width && y >= 0 && y < height && !isWall(x, y)) {
+    // Only add target if position is valid (not a wall, within bounds and free)
+    if (x >= 0 && x < width && y >= 0 && y < height && !isWall(x, y) &&
+        findTarget(cellOffset(x, y)) == NO_TARGET) {
         Target newTarget{x, y, points, false};
+        targetIndex[cellOffset(x, y)] = static_cast<int>(targets.size());
         targets.push_back(newTarget);
+        touch();
     }
 }
 
 void Map::removeTarget(int x, int y) {
-    for (auto it = targets.begin(); it != targets.end(); ++it) {
-        if (it->x == x && it->y == y) {
-            targets.erase(it);
-            return;
-        }
+    int index = getTargetIndex(x, y);
+    if (index == NO_TARGET) return;
+
+    targets.erase(targets.begin() + index);
+    targetIndex.erase(cellOffset(x, y));
+
+    // Targets after the removed one shifted down by one
+    for (size_t i = index; i < targets.size(); i++) {
+        targetIndex[cellOffset(targets[i].x, targets[i].y)] = static_cast<int>(i);
     }
+    touch();
 }
 
 const std::vector<Target>& Map::getTargets() const {
@@ -157,44 +474,222 @@ const std::vector<Target>& Map::getTargets() const {
 }
 
 bool Map::hitTarget(int x, int y) {
-    for (auto& target : targets) {
-        if (target.x == x && target.y == y && !target.hit) {
-            target.hit = true;
-            return true;
-        }
+    int index = getTargetIndex(x, y);
+    if (index != NO_TARGET && !targets[index].hit) {
+        targets[index].hit = true;
+        touch();
+        return true;
     }
     return false;
 }
 
 int Map::getTargetPoints(int x, int y) const {
-    for (const auto& target : targets) {
-        if (target.x == x && target.y == y) {
-            return target.points;
-        }
-    }
-    return 0;
+    int index = getTargetIndex(x, y);
+    return index != NO_TARGET ? targets[index].points : 0;
 }
 
 void Map::resetTargets() {
     for (auto& target : targets) {
         target.hit = false;
     }
+    touch();
 }
 
 bool Map::isTarget(int x, int y) const {
-    for (const auto& target : targets) {
-        if (target.x == x && target.y == y) {
-            return true;
+    return getTargetIndex(x, y) != NO_TARGET;
+}
+
+bool Map::isHitTarget(int x, int y) const {
+    int index = getTargetIndex(x, y);
+    return index != NO_TARGET && targets[index].hit;
+}
+
+void Map::clearTargets() {
+    targetIndex.clear();
+    targets.clear();
+    touch();
+}
+
+void Map::setRegion(int x, int y, int regionWidth, int regionHeight,
+                    const std::uint8_t* source, int sourceStride, const std::vector<Target>& blockTargets) {
+    int left = std::max(0, x), top = std::max(0, y);
+    int right = std::min(width, x + regionWidth), bottom = std::min(height, y + regionHeight);
+    if (left >= right || top >= bottom) return;
+
+    // Drop the block's old targets. Only compact the list if there are any,
+    // so filling an empty block doesn't rewrite the index.
+    std::vector<int> oldTargets;
+    findTargetsIn(left, top, right, bottom, oldTargets);
+    if (!oldTargets.empty()) {
+        size_t kept = 0;
+        for (size_t i = 0; i < targets.size(); i++) {
+            const Target& target = targets[i];
+            int offset = cellOffset(target.x, target.y);
+            if (target.x >= left && target.x < right && target.y >= top && target.y < bottom) {
+                targetIndex.erase(offset);
+                continue;
+            }
+            targetIndex[offset] = static_cast<int>(kept);
+            targets[kept++] = target;
         }
+        targets.resize(kept);
     }
-    return false;
+
+    for (int row = top; row < bottom; row++) {
+        std::uint8_t* destination = cells + cellOffset(left, row);
+        if (source) {
+            std::memcpy(destination, source + static_cast<std::size_t>(row - y) * sourceStride + (left - x), right - left);
+        } else {
+            std::fill_n(destination, right - left, STANDARD_WALL);
+        }
+    }
+
+    for (const Target& target : blockTargets) {
+        int targetX = x + target.x, targetY = y + target.y;
+        if (targetX < left || targetX >= right || targetY < top || targetY >= bottom) continue;
+        int offset = cellOffset(targetX, targetY);
+        if (cells[offset] != EMPTY || findTarget(offset) != NO_TARGET) continue;
+        targetIndex[offset] = static_cast<int>(targets.size());
+        targets.push_back(Target{targetX, targetY, target.points, target.hit});
+    }
+    countOccupancy(left + PADDING, top + PADDING, right + PADDING, bottom + PADDING);
+    touch();
 }
 
-bool Map::isHitTarget(int x, int y) const {
-    for (const auto& target : targets) {
-        if (target.x == x && target.y == y) {
-            return target.hit;
+void Map::getRegion(int x, int y, int regionWidth, int regionHeight,
+                    std::uint8_t* destination, int destinationStride, std::vector<Target>& blockTargets) const {
+    int left = std::max(0, x), top = std::max(0, y);
+    int right = std::min(width, x + regionWidth), bottom = std::min(height, y + regionHeight);
+    blockTargets.clear();
+    if (left >= right || top >= bottom) return;
+
+    for (int row = top; row < bottom; row++) {
+        std::memcpy(destination + static_cast<std::size_t>(row - y) * destinationStride + (left - x),
+                    cells + cellOffset(left, row), right - left);
+    }
+
+    std::vector<int> indices;
+    findTargetsIn(left, top, right, bottom, indices);
+    for (int index : indices) {
+        Target target = targets[index];
+        target.x -= x;
+        target.y -= y;
+        blockTargets.push_back(target);
+    }
+}
+
+// Occupancy pyramid: level l has blocks of 1 << (emptyBlockShiftMin + 2 * l)
+// cells per side, in padded coordinates
+namespace {
+
+const int occupancyLevels = 3;
+
+inline int occupancyShift(int level)
+{
+    return Map::emptyBlockShiftMin + 2 * level;
+}
+
+} // namespace
+
+void Map::resetOccupancy() {
+    int paddedHeight = height + 2 * PADDING;
+    for (int level = 0; level < occupancyLevels; level++) {
+        int size = 1 << occupancyShift(level);
+        blockStrides[level] = (stride + size - 1) >> occupancyShift(level);
+        int rows = (paddedHeight + size - 1) >> occupancyShift(level);
+        occupiedCounts[level].assign(static_cast<std::size_t>(blockStrides[level]) * rows, 0);
+    }
+    emptyBlockShifts.assign(occupiedCounts[0].size() + 3, 0);   // Spare bytes for 32-bit gathers
+    countOccupancy(0, 0, stride, paddedHeight);
+}
+
+void Map::countOccupancy(int left, int top, int right, int bottom) {
+    // Widen to whole blocks of the coarsest level, so every level is recounted whole
+    const int coarse = occupancyShift(occupancyLevels - 1);
+    const int paddedHeight = height + 2 * PADDING;
+    left = (std::max(0, left) >> coarse) << coarse;
+    top = (std::max(0, top) >> coarse) << coarse;
+    right = std::min(stride, ((right + (1 << coarse) - 1) >> coarse) << coarse);
+    bottom = std::min(paddedHeight, ((bottom + (1 << coarse) - 1) >> coarse) << coarse);
+    if (left >= right || top >= bottom) return;
+
+    for (int level = 0; level < occupancyLevels; level++) {
+        int shift = occupancyShift(level);
+        for (int by = top >> shift; by <= (bottom - 1) >> shift; by++) {
+            std::uint16_t* row = occupiedCounts[level].data() + static_cast<std::size_t>(by) * blockStrides[level];
+            std::fill(row + (left >> shift), row + ((right - 1) >> shift) + 1, 0);
+        }
+    }
+
+    // Walls, one 4-cell block row at a time (left is block aligned): the
+    // high bit of each byte of nonZero is set for a wall
+    std::uint16_t* counts = occupiedCounts[0].data();
+    const int shift = emptyBlockShiftMin;
+    for (int y = top; y < bottom; y++) {
+        const std::uint8_t* row = cells + static_cast<std::size_t>(y) * stride;
+        std::uint16_t* countRow = counts + static_cast<std::size_t>(y >> shift) * blockStrides[0];
+        int x = left;
+        for (; x + 4 <= right; x += 4) {
+            std::uint32_t word;
+            std::memcpy(&word, row + x, sizeof(word));
+            std::uint32_t nonZero = (((word & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | word) & 0x80808080u;
+            countRow[x >> shift] += static_cast<std::uint16_t>(((nonZero >> 7) * 0x01010101u) >> 24);
+        }
+        for (; x < right; x++) {
+            countRow[x >> shift] += row[x] != EMPTY;
+        }
+    }
+
+    // Coarser levels are sums of the finer one
+    for (int level = 1; level < occupancyLevels; level++) {
+        int fineShift = occupancyShift(level - 1);
+        for (int by = top >> fineShift; by <= (bottom - 1) >> fineShift; by++) {
+            const std::uint16_t* fine = occupiedCounts[level - 1].data() + static_cast<std::size_t>(by) * blockStrides[level - 1];
+            std::uint16_t* coarseRow = occupiedCounts[level].data() + static_cast<std::size_t>(by >> 2) * blockStrides[level];
+            for (int bx = left >> fineShift; bx <= (right - 1) >> fineShift; bx++) {
+                coarseRow[bx >> 2] += fine[bx];
+            }
+        }
+    }
+
+    refreshEmptyBlockShifts(left, top, right, bottom);
+}
+
+void Map::occupancyChanged(int x, int y, bool wasOccupied) {
+    bool occupied = isOccupied(cellOffset(x, y));
+    if (occupied == wasOccupied) return;
+
+    // A block that became empty or stopped being empty changes the shifts under it
+    int px = x + PADDING, py = y + PADDING;
+    int changedShift = -1;
+    for (int level = 0; level < occupancyLevels; level++) {
+        int shift = occupancyShift(level);
+        std::uint16_t& count = occupiedCounts[level][static_cast<std::size_t>(py >> shift) * blockStrides[level] + (px >> shift)];
+        count = occupied ? count + 1 : count - 1;
+        if (count == (occupied ? 1 : 0)) changedShift = shift;
+    }
+    if (changedShift < 0) return;
+
+    int left = (px >> changedShift) << changedShift, top = (py >> changedShift) << changedShift;
+    refreshEmptyBlockShifts(left, top, std::min(stride, left + (1 << changedShift)),
+                            std::min(height + 2 * PADDING, top + (1 << changedShift)));
+}
+
+void Map::refreshEmptyBlockShifts(int left, int top, int right, int bottom) {
+    const int fineShift = emptyBlockShiftMin;
+    for (int by = top >> fineShift; by <= (bottom - 1) >> fineShift; by++) {
+        std::uint8_t* row = emptyBlockShifts.data() + static_cast<std::size_t>(by) * blockStrides[0];
+        for (int bx = left >> fineShift; bx <= (right - 1) >> fineShift; bx++) {
+            // Largest empty block first
+            std::uint8_t shift = 0;
+            for (int level = occupancyLevels - 1; level >= 0; level--) {
+                int levelShift = occupancyShift(level) - fineShift;
+                if (occupiedCounts[level][static_cast<std::size_t>(by >> levelShift) * blockStrides[level] + (bx >> levelShift)] == 0) {
+                    shift = static_cast<std::uint8_t>(occupancyShift(level));
+                    break;
+                }
+            }
+            row[bx] = shift;
         }
     }
-    return false;
 }
@@ -1,5 +1,8 @@
 // Map.hpp
 #pragma once
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
@@ -15,8 +18,22 @@ class Map {
 private:
     int width;
     int height;
-    std::vector<std::vector<int>> grid;
+    int stride;                        // Cells per padded row: width + 2 * PADDING
+    std::vector<std::uint8_t> ownedCells;  // Grid storage, unless it was loaded from a binary file
+    MappedFile mappedFile;                 // Binary map file the grid lives in (copy-on-write)
+    std::uint8_t* cells;                   // Padded wall grid, one byte per cell, row-major
     std::vector<Target> targets;  // Collection of targets
+    // Padded cell offset (cellOffset) to index into targets, for cells with a
+    // target only. Sparse, so a mapped binary grid isn't shadowed by an int per cell.
+    std::unordered_map<int, int> targetIndex;
+    std::uint64_t revision;       // See getRevision()
+
+    // Occupancy pyramid over the padded grid, for empty-space skipping: the
+    // number of wall cells in each block of every level,
+    // and per 4x4 block the shift of the largest empty block containing it
+    std::vector<std::uint16_t> occupiedCounts[3];
+    int blockStrides[3] = {};
+    std::vector<std::uint8_t> emptyBlockShifts;
     // In Map.hpp, define constants for clarity
 // In Map.hpp, define constants for clarity
     static const int EMPTY = 0;
@@ -26,14 +43,81 @@ private:
     static const int NEON_BARRIER = 4;
     static const int HOLOGRAM = 5;
 
+    void allocateCells(int newWidth, int newHeight);
+    bool loadText(const std::string& filename);
+    bool loadBinary(MappedFile file, const std::string& filename);
+    void rebuildTargetIndex();
+    int findTarget(int offset) const;   // Index into targets, or NO_TARGET
+    // Indices of the targets in cells [left, right) x [top, bottom), row-major
+    void findTargetsIn(int left, int top, int right, int bottom, std::vector<int>& indices) const;
+    void touch();  // Record an edit: take a fresh revision
+
+    bool isOccupied(int offset) const { return cells[offset] != EMPTY; }
+    void resetOccupancy();   // Size and count everything after the grid changed size
+    void countOccupancy(int left, int top, int right, int bottom);   // Recount the blocks over these cells
+    void occupancyChanged(int x, int y, bool wasOccupied);           // Update for one edited cell
+    void refreshEmptyBlockShifts(int left, int top, int right, int bottom);  // Padded cells
+
+    int cellOffset(int x, int y) const {
+        return (y + PADDING) * stride + x + PADDING;
+    }
+
 public:
+    static constexpr int NO_TARGET = -1;
+
+    // Solid border around the map. A DDA ray moves one cell per step, so a
+    // ray starting inside the map always stops in the padding at the latest.
+    static constexpr int PADDING = 1;
+
     Map(int width = 20, int height = 20);
     
-    void loadFromFile(const std::string& filename);
-    void saveToFile(const std::string& filename) const;
+    // Largest width or height a loaded map may have
+    static constexpr int MAX_SIZE = 1 << 15;
+
+    // Text or binary (MapFile.hpp), told apart by the file's magic. Replaces
+    // walls and targets; on failure prints why and leaves the map unchanged.
+    // A binary grid is mapped in place rather than read.
+    bool loadFromFile(const std::string& filename);
+    bool saveToFile(const std::string& filename) const;
+    // chunkSize > 0 writes a chunk index, with the targets grouped by chunk
+    bool saveToBinaryFile(const std::string& filename, int chunkSize = 64) const;
     
     int getValueAt(int x, int y) const;
+    void setValueAt(int x, int y, int value);  // Ignored outside the map
+
+    // Wall type for scalar ray marchers. No bounds test: x and y may be at
+    // most PADDING cells outside the map, where the border reads as a
+    // standard wall. getValueAt returns -1 there instead, which would never
+    // stop a ray.
+    int getWallTypeUnchecked(int x, int y) const {
+        return cells[cellOffset(x, y)];
+    }
+
+    // Raw padded storage for SIMD lookups: cell (x, y) lives at y * getStride() + x
+    // from this pointer. Bytes may be loaded 4 at a time; the tail is padded for it.
+    const std::uint8_t* getCellData() const { return cells + cellOffset(0, 0); }
+    int getStride() const { return stride; }
+
+    // Empty-space skipping. Cell (x, y) lies in an empty block (no walls;
+    // targets don't stop rays) of 1 << shift cells per side, aligned to that size in padded
+    // coordinates (x + PADDING, y + PADDING); shift is 0 if there is none.
+    // The raw table is indexed by ((y + PADDING) >> 2) * getEmptyBlockStride()
+    // + ((x + PADDING) >> 2) and covers the padding, which is never empty.
+    // Like the cells, it may be loaded 4 bytes at a time.
+    static constexpr int emptyBlockShiftMin = 2;     // 4x4, 16x16 and 64x64 blocks
+    static constexpr int emptyBlockShiftMax = 6;
+    int getEmptyBlockShift(int x, int y) const {
+        return emptyBlockShifts[((y + PADDING) >> emptyBlockShiftMin) * blockStrides[0] + ((x + PADDING) >> emptyBlockShiftMin)];
+    }
+    const std::uint8_t* getEmptyBlockShiftData() const { return emptyBlockShifts.data(); }
+    int getEmptyBlockStride() const { return blockStrides[0]; }
     bool isWall(int x, int y) const;
+
+    // Changes on every edit of walls or targets (including target hits), so
+    // renderers can tell whether cached results still match. Revisions are
+    // never reused, not even by another Map.
+    std::uint64_t getRevision() const { return revision; }
+
     int getWidth() const;
     int getHeight() const;
     
@@ -46,4 +130,17 @@ public:
     void resetTargets();  // Reset all targets to unhit state
     bool isTarget(int x, int y) const;  // Check if location has a target
     bool isHitTarget(int x, int y) const;  // Check if target has been hit
+    int getTargetIndex(int x, int y) const;  // Index into getTargets(), or NO_TARGET
+    void clearTargets();
+
+    // Block copies, for streaming a larger world through the map. setRegion
+    // overwrites cells [x, x + regionWidth) x [y, y + regionHeight) from
+    // source, or with solid wall if source is null, and replaces the targets
+    // in the block with blockTargets (positions relative to x, y; walls and
+    // duplicates are skipped as in addTarget). Parts outside the map are ignored.
+    void setRegion(int x, int y, int regionWidth, int regionHeight,
+                   const std::uint8_t* source, int sourceStride, const std::vector<Target>& blockTargets);
+    // The reverse: copy the block's cells and targets (relative to x, y) out
+    void getRegion(int x, int y, int regionWidth, int regionHeight,
+                   std::uint8_t* destination, int destinationStride, std::vector<Target>& blockTargets) const;
 };
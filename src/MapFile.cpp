@@ -0,0 +1,41 @@
+// MapFile.cpp
+#include "MapFile.hpp"
+#include <cstring>
+#include <iostream>
+
+bool readMapFileHeader(const MappedFile& file, const std::string& filename, MapFileHeader& header)
+{
+    if (file.size() < sizeof(header) || std::memcmp(file.data(), mapFileMagic, sizeof(mapFileMagic)) != 0)
+    {
+        std::cerr << "Error: " << filename << " is not a map file or is truncated" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (header.version != mapFileVersion)
+    {
+        std::cerr << "Error: Map file " << filename << " has unsupported version " << header.version << std::endl;
+        return false;
+    }
+    if (header.headerSize < sizeof(header) || header.width <= 0 || header.height <= 0 || header.padding > 64)
+    {
+        std::cerr << "Error: Map file " << filename << " has an invalid header" << std::endl;
+        return false;
+    }
+
+    // Every section must lie inside the file
+    std::uint64_t gridBytes = mapFileStride(header) * (static_cast<std::uint64_t>(header.height) + 2 * header.padding) + 3;
+    std::uint64_t size = file.size();
+    auto fits = [size](std::uint64_t offset, std::uint64_t count, std::uint64_t recordSize) {
+        return offset <= size && count <= (size - offset) / recordSize;
+    };
+    std::uint64_t chunkCount = mapFileChunkCount(header);
+    if (!fits(header.cellsOffset, gridBytes, 1) ||
+        !fits(header.targetsOffset, header.targetCount, sizeof(MapFileTarget)) ||
+        (chunkCount > 0 && !fits(header.chunksOffset, chunkCount, sizeof(MapFileChunk))))
+    {
+        std::cerr << "Error: Map file " << filename << " is truncated" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+// MapFile.hpp
+#pragma once
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <string>
+
+// Binary map file (.rcmap). All numbers are little-endian; every section
+// starts on a 64-byte boundary.
+//
+//   MapFileHeader
+//   cells    (width + 2 * padding) x (height + 2 * padding) bytes plus 3 spare,
+//            row-major with a solid border: exactly Map's in-memory grid, so
+//            a load maps it in place
+//   targets  targetCount MapFileTarget records
+//   chunks   optional: chunksX * chunksY MapFileChunk records, row-major,
+//            for chunkSize x chunkSize cell chunks. With an index, targets
+//            are grouped by chunk in the same order.
+//
+// Readers must reject a version they don't know; the header size lets
+// later versions append fields.
+
+const char mapFileMagic[4] = {'R', 'C', 'M', 'B'};
+const std::uint32_t mapFileVersion = 1;
+const std::uint64_t mapFileAlignment = 64;
+
+struct MapFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t headerSize;       // sizeof(MapFileHeader) when written
+    std::int32_t width;
+    std::int32_t height;
+    std::uint32_t padding;          // Border cells on each side, Map::PADDING
+    std::uint32_t chunkSize;        // 0 = no chunk index
+    std::uint32_t reserved;
+    std::uint64_t cellsOffset;
+    std::uint64_t targetsOffset;
+    std::uint64_t targetCount;
+    std::uint64_t chunksOffset;     // 0 = no chunk index
+};
+
+struct MapFileTarget {
+    std::int32_t x;
+    std::int32_t y;
+    std::int32_t points;
+    std::uint32_t flags;            // mapFileTargetHit
+};
+
+const std::uint32_t mapFileTargetHit = 1;
+
+struct MapFileChunk {
+    std::uint32_t firstTarget;      // Into the target table
+    std::uint32_t targetCount;
+    std::uint32_t wallCells;        // Non-empty cells; 0 lets a reader skip the chunk
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(MapFileHeader) == 64, "MapFileHeader layout is part of the file format");
+static_assert(sizeof(MapFileTarget) == 16, "MapFileTarget layout is part of the file format");
+static_assert(sizeof(MapFileChunk) == 16, "MapFileChunk layout is part of the file format");
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Map files are read in place as little-endian");
+#endif
+
+// Round a file offset up to the section alignment
+inline std::uint64_t alignMapFileOffset(std::uint64_t offset)
+{
+    return (offset + mapFileAlignment - 1) / mapFileAlignment * mapFileAlignment;
+}
+
+// Cells per padded row of the grid section
+inline std::uint64_t mapFileStride(const MapFileHeader& header)
+{
+    return static_cast<std::uint64_t>(header.width) + 2 * header.padding;
+}
+
+// Records in the chunk index; 0 without one
+inline std::uint64_t mapFileChunkCount(const MapFileHeader& header)
+{
+    if (header.chunkSize == 0) return 0;
+    std::uint64_t chunksX = (static_cast<std::uint64_t>(header.width) + header.chunkSize - 1) / header.chunkSize;
+    std::uint64_t chunksY = (static_cast<std::uint64_t>(header.height) + header.chunkSize - 1) / header.chunkSize;
+    return chunksX * chunksY;
+}
+
+// Copy out and check the header of a mapped map file: magic, version, sizes,
+// and that every section lies inside the file. Prints why on failure.
+bool readMapFileHeader(const MappedFile& file, const std::string& filename, MapFileHeader& header);
@@ -0,0 +1,108 @@
+// MappedFile.cpp
+#include "MappedFile.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)),
+      length(std::exchange(other.length, 0)),
+      heap(std::exchange(other.heap, false))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+        heap = std::exchange(other.heap, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+#if MAPPED_FILE_POSIX
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        std::cerr << "Error: " << path << " is empty or unreadable" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // Private and writable: edits are copy-on-write and stay in this process
+    std::size_t fileSize = static_cast<std::size_t>(info.st_size);
+    void* mapping = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);   // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Error: Could not map " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    bytes = static_cast<std::uint8_t*>(mapping);
+    length = fileSize;
+    heap = false;
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+
+    std::streamoff fileSize = file.tellg();
+    if (fileSize <= 0) {
+        std::cerr << "Error: " << path << " is empty or unreadable" << std::endl;
+        return false;
+    }
+
+    bytes = new std::uint8_t[static_cast<std::size_t>(fileSize)];
+    length = static_cast<std::size_t>(fileSize);
+    heap = true;
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(bytes), fileSize)) {
+        std::cerr << "Error: Could not read " << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+#endif
+}
+
+void MappedFile::close()
+{
+    if (!bytes) return;
+
+    if (heap) {
+        delete[] bytes;
+    }
+#if MAPPED_FILE_POSIX
+    else {
+        munmap(bytes, length);
+    }
+#endif
+
+    bytes = nullptr;
+    length = 0;
+    heap = false;
+}
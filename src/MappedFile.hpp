@@ -0,0 +1,33 @@
+// MappedFile.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A whole file mapped into memory, private to this process: writes go to
+// copy-on-write pages and never reach the file. Pages are read on first
+// touch, so opening a large file costs next to nothing. Where mmap isn't
+// available the file is read into memory instead.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Replaces any earlier mapping; returns false (and prints why) on failure
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return bytes != nullptr; }
+    std::uint8_t* data() const { return bytes; }
+    std::size_t size() const { return length; }
+
+private:
+    std::uint8_t* bytes = nullptr;
+    std::size_t length = 0;
+    bool heap = false;      // Read into memory rather than mapped
+};
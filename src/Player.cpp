@@ -1,6 +1,6 @@
 // Player.cpp
 #include "Player.hpp"
-#include <SFML/Window/Keyboard.hpp>
+#include "StateHash.hpp"
 #include <cmath>
 #include "Map.hpp"
 
@@ -20,45 +20,12 @@ Player::Player()
 {
 }
 
-void Player::checkTargetHits(Player& player, Map& map) {
-    // Only check for hits if the player is currently dashing
-    if (player.getIsDashing()) {
-        // Get player position
-        sf::Vector2f pos = player.getPosition();
-        
-        // Check targets within a small radius around the player
-        float hitRadius = 1.0f; // Adjust this value based on testing
-        
-        // Get all targets
-        const std::vector<Target>& targets = map.getTargets();
-        
-        for (const auto& target : targets) {
-            // Calculate distance from player to target
-            float dx = pos.x - target.x;
-            float dy = pos.y - target.y;
-            float distSquared = dx*dx + dy*dy;
-            
-            // If player is close enough and target not hit yet, register a hit
-            if (distSquared < hitRadius*hitRadius) {
-                if (map.hitTarget(target.x, target.y)) {
-                    // Target was hit successfully - add points, play sound, etc.
-                    player.addScore(map.getTargetPoints(target.x, target.y));
-                    
-                    // Optional: add visual or audio feedback
-                    // playSound("target_hit.wav");
-                }
-            }
-        }
-    }
-}
-
-void Player::handleInput(float deltaTime, const sf::Keyboard::Key pressedKeys[], const Map& map) {
+void Player::handleInput(float deltaTime, const InputState& input, const Map& map) {
     float moveStep = moveSpeed * deltaTime;
     sf::Vector2f newPosition = position;
     
     // Check for dash input
-    bool shiftPressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LShift) || 
-                        sf::Keyboard::isKeyPressed(sf::Keyboard::Key::RShift);
+    bool shiftPressed = input.isDown(InputDash);
     
     // Trigger dash on key press (not held)
     if (shiftPressed && !lastDashTriggered && dashCooldownTimer <= 0.0f && !isDashing) {
@@ -72,25 +39,25 @@ void Player::handleInput(float deltaTime, const sf::Keyboard::Key pressedKeys[],
     // Regular movement if not dashing
     if (!isDashing) {
         // Move forward
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) {
+        if (input.isDown(InputForward)) {
             newPosition.x += direction.x * moveStep;
             newPosition.y += direction.y * moveStep;
         }
 
         // Move backward
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) {
+        if (input.isDown(InputBackward)) {
             newPosition.x -= direction.x * moveStep;
             newPosition.y -= direction.y * moveStep;
         }
 
         // Strafe left (move sideways to the left)
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) {
+        if (input.isDown(InputStrafeLeft)) {
             newPosition.x -= plane.x * moveStep;
             newPosition.y -= plane.y * moveStep;
         }
 
         // Strafe right (move sideways to the right)
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) {
+        if (input.isDown(InputStrafeRight)) {
             newPosition.x += plane.x * moveStep;
             newPosition.y += plane.y * moveStep;
         }
@@ -106,8 +73,8 @@ void Player::handleInput(float deltaTime, const sf::Keyboard::Key pressedKeys[],
     // Check for collisions and apply sliding behavior
     applyCollisionWithSliding(newPosition, map);
 
-    // Rotate left
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) {
+    // Turn right
+    if (input.isDown(InputTurnRight)) {
         float rotSpeed = this->rotSpeed * deltaTime;
         float oldDirX = direction.x;
         direction.x = direction.x * cos(rotSpeed) - direction.y * sin(rotSpeed);
@@ -118,8 +85,8 @@ void Player::handleInput(float deltaTime, const sf::Keyboard::Key pressedKeys[],
         plane.y = oldPlaneX * sin(rotSpeed) + plane.y * cos(rotSpeed);
     }
 
-    // Rotate right
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left)) {
+    // Turn left
+    if (input.isDown(InputTurnLeft)) {
         float rotSpeed = -this->rotSpeed * deltaTime;
         float oldDirX = direction.x;
         direction.x = direction.x * cos(rotSpeed) - direction.y * sin(rotSpeed);
@@ -225,6 +192,13 @@ sf::Vector2f Player::getPlane() const
     return plane;
 }
 
+void Player::setPose(const sf::Vector2f& newPosition, const sf::Vector2f& newDirection, const sf::Vector2f& newPlane)
+{
+    position = newPosition;
+    direction = newDirection;
+    plane = newPlane;
+}
+
 bool Player::getIsDashing() const
 {
     return isDashing;
@@ -234,3 +208,15 @@ float Player::getDashCooldownPercent() const
 {
     return dashCooldownTimer / dashCooldown;
 }
+
+std::uint64_t Player::hashState(std::uint64_t seed) const
+{
+    StateHash hash(seed);
+    hash.add(position.x).add(position.y);
+    hash.add(direction.x).add(direction.y);
+    hash.add(plane.x).add(plane.y);
+    hash.add(isDashing).add(dashTimer).add(dashCooldownTimer);
+    hash.add(dashDirection.x).add(dashDirection.y).add(lastDashTriggered);
+    hash.add(score);
+    return hash.get();
+}
@@ -1,7 +1,8 @@
 // Player.hpp
 #pragma once
 #include <SFML/System/Vector2.hpp>
-#include <SFML/Window/Keyboard.hpp>
+#include "Input.hpp"
+#include <cstdint>
 
 class Map;
 
@@ -29,12 +30,13 @@ private:
 
 public:
     Player();
-    void handleInput(float deltaTime, const sf::Keyboard::Key pressedKeys[], const Map& map);
+    // Move, turn and start dashes for one step. Reads nothing but its arguments.
+    void handleInput(float deltaTime, const InputState& input, const Map& map);
     void update(float deltaTime);
     sf::Vector2f getPosition() const;
     sf::Vector2f getDirection() const;
     sf::Vector2f getPlane() const;
-    void checkTargetHits(Player& player, Map& map);
+    void setPose(const sf::Vector2f& newPosition, const sf::Vector2f& newDirection, const sf::Vector2f& newPlane);
     void addScore(int points) {
         score += points;
         // Optional: add visual feedback when score changes
@@ -47,4 +49,7 @@ public:
     // Dash-related public methods
     bool getIsDashing() const;
     float getDashCooldownPercent() const;  // Returns a value from 0 to 1 for UI display
+
+    // Hash of the pose and dash state, mixed into seed; see hashSimulationState
+    std::uint64_t hashState(std::uint64_t seed) const;
 };
@@ -0,0 +1,368 @@
+// PostProcess.cpp
+#include "PostProcess.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 0.7 * c and 0.3 * c for every channel value, exactly as the float blend computes them
+struct BlendTables {
+    float keep[256];
+    float mix[256];
+
+    BlendTables()
+    {
+        for (int c = 0; c < 256; c++) {
+            keep[c] = c * 0.7f;
+            mix[c] = c * 0.3f;
+        }
+    }
+};
+
+const BlendTables& blendTables()
+{
+    static const BlendTables tables;
+    return tables;
+}
+
+inline Pixel blendPixels(Pixel original, Pixel sample, const BlendTables& tables)
+{
+    return packColor(
+        static_cast<std::uint8_t>(tables.keep[pixelRed(original)] + tables.mix[pixelRed(sample)]),
+        static_cast<std::uint8_t>(tables.keep[pixelGreen(original)] + tables.mix[pixelGreen(sample)]),
+        static_cast<std::uint8_t>(tables.keep[pixelBlue(original)] + tables.mix[pixelBlue(sample)]));
+}
+
+#if defined(__SSE2__)
+// 0.7 * a + 0.3 * b per channel, truncated, for 4 pixels. Plain SSE2 multiplies
+// and adds round exactly like the scalar float code, so results are identical.
+inline __m128i blendPixels4(__m128i original, __m128i sample)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 keep = _mm_set1_ps(0.7f);
+    const __m128 mix = _mm_set1_ps(0.3f);
+
+    auto blendChannels = [&](__m128i a, __m128i b) {
+        __m128 sum = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(a), keep), _mm_mul_ps(_mm_cvtepi32_ps(b), mix));
+        return _mm_cvttps_epi32(sum);
+    };
+
+    __m128i aLo = _mm_unpacklo_epi8(original, zero), aHi = _mm_unpackhi_epi8(original, zero);
+    __m128i bLo = _mm_unpacklo_epi8(sample, zero), bHi = _mm_unpackhi_epi8(sample, zero);
+
+    __m128i p0 = blendChannels(_mm_unpacklo_epi16(aLo, zero), _mm_unpacklo_epi16(bLo, zero));
+    __m128i p1 = blendChannels(_mm_unpackhi_epi16(aLo, zero), _mm_unpackhi_epi16(bLo, zero));
+    __m128i p2 = blendChannels(_mm_unpacklo_epi16(aHi, zero), _mm_unpacklo_epi16(bHi, zero));
+    __m128i p3 = blendChannels(_mm_unpackhi_epi16(aHi, zero), _mm_unpackhi_epi16(bHi, zero));
+
+    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+    return _mm_or_si128(packed, _mm_set1_epi32(static_cast<int>(0xFF000000u)));
+}
+
+// Every other pixel of 8 consecutive ones
+inline __m128i evenPixels(const Pixel* pixels)
+{
+    __m128 a = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)));
+    __m128 b = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 4)));
+    return _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+#endif
+
+// Saturating add of color * amount (truncated per channel)
+template <typename T>
+inline Pixel addScaled(Pixel pixel, const sf::Color& color, T amount)
+{
+    return packColor(
+        static_cast<std::uint8_t>(std::min(255, pixelRed(pixel) + static_cast<int>(color.r * amount))),
+        static_cast<std::uint8_t>(std::min(255, pixelGreen(pixel) + static_cast<int>(color.g * amount))),
+        static_cast<std::uint8_t>(std::min(255, pixelBlue(pixel) + static_cast<int>(color.b * amount))));
+}
+
+} // namespace
+
+void PostProcessor::run(FrameBuffer& frame, ThreadPool& pool, std::initializer_list<PostProcessPass*> passes)
+{
+    PostProcessPass* const* first = passes.begin();
+    PostProcessPass* const* last = passes.end();
+    int height = frame.getHeight();
+    int width = frame.getWidth();
+
+    while (first != last) {
+        // A stage is one snapshot-reading pass (or any pass) plus the local passes after it
+        PostProcessPass* const* stageEnd = first + 1;
+        while (stageEnd != last && !(*stageEnd)->readsSnapshot()) ++stageEnd;
+
+        if ((*first)->readsSnapshot()) {
+            snapshot.resize(width, height);
+            pool.parallelFor(0, height, tileRows, [&](int begin, int end) {
+                std::copy(frame.row(begin), frame.row(begin) + static_cast<std::size_t>(end - begin) * width,
+                          snapshot.row(begin));
+            });
+        }
+
+        pool.parallelFor(0, height, tileRows, [&](int begin, int end) {
+            PROFILE_SCOPE(PostTile);
+            for (PostProcessPass* const* pass = first; pass != stageEnd; ++pass) {
+                (*pass)->apply(frame, snapshot, begin, end);
+            }
+        });
+
+        first = stageEnd;
+    }
+}
+
+void DirectionalBlurPass::setDirection(float dirX, float dirY, float strength)
+{
+    offsetX = static_cast<int>(dirX * 3.0f * strength);
+    offsetY = static_cast<int>(dirY * 3.0f * strength);
+}
+
+void DirectionalBlurPass::apply(FrameBuffer& frame, const FrameBuffer& snapshot, int rowBegin, int rowEnd)
+{
+    const BlendTables& tables = blendTables();
+    const FrameBuffer& source = readsSnapshot() ? snapshot : frame;
+    int width = frame.getWidth();
+    int height = frame.getHeight();
+
+    // Process every other line and pixel, writing each result to its whole 2x2 block
+    for (int y = rowBegin + (rowBegin & 1); y < rowEnd; y += 2) {
+        int blurY = y - offsetY;
+        if (blurY < 0 || blurY >= height) continue;
+
+        const Pixel* original = source.row(y);
+        const Pixel* sample = source.row(blurY);
+        Pixel* out = frame.row(y);
+        Pixel* below = y + 1 < height ? frame.row(y + 1) : nullptr;
+
+        // Columns whose sample lands inside the frame
+        int xBegin = std::max(0, offsetX);
+        int xEnd = std::min(width, width + offsetX);
+        xBegin += xBegin & 1;
+
+        int x = xBegin;
+#if defined(__SSE2__)
+        // 4 blocks at a time; the last 8 pixels read must stay inside the row
+        if (below) {
+            int sampleShift = -offsetX;
+            for (; x + 8 <= xEnd && x + 8 <= width && x + sampleShift + 8 <= width; x += 8) {
+                __m128i blended = blendPixels4(evenPixels(original + x), evenPixels(sample + x + sampleShift));
+                __m128i left = _mm_unpacklo_epi32(blended, blended);
+                __m128i right = _mm_unpackhi_epi32(blended, blended);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), left);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x + 4), right);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(below + x), left);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(below + x + 4), right);
+            }
+        }
+#endif
+        for (; x < xEnd; x += 2) {
+            Pixel packed = blendPixels(original[x], sample[x - offsetX], tables);
+            out[x] = packed;
+            if (x + 1 < width) out[x + 1] = packed;
+            if (below) {
+                below[x] = packed;
+                if (x + 1 < width) below[x + 1] = packed;
+            }
+        }
+    }
+}
+
+void BorderGlowPass::setGlow(int bandWidth, sf::Color color, float intensity)
+{
+    band = bandWidth;
+    glowColor = color;
+    glowIntensity = intensity;
+}
+
+void BorderGlowPass::apply(FrameBuffer& frame, const FrameBuffer&, int rowBegin, int rowEnd)
+{
+    int width = frame.getWidth();
+    int height = frame.getHeight();
+    float bandWidth = static_cast<float>(band);
+
+    auto glowRange = [&](Pixel* row, int y, int xBegin, int xEnd) {
+        for (int x = xBegin; x < xEnd; x++) {
+            float edgeDistance = std::min(
+                std::min(static_cast<float>(x), static_cast<float>(y)),
+                std::min(static_cast<float>(width - x), static_cast<float>(height - y)));
+            if (edgeDistance < bandWidth) {
+                float fade = (1.0f - edgeDistance / bandWidth) * glowIntensity;
+                row[x] = addScaled(row[x], glowColor, fade);
+            }
+        }
+    };
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        Pixel* row = frame.row(y);
+        if (y < band || height - y < band) {
+            glowRange(row, y, 0, width);
+        } else {
+            // Middle rows: only the left and right bands can glow
+            int leftEnd = std::min(band, width);
+            glowRange(row, y, 0, leftEnd);
+            glowRange(row, y, std::max(leftEnd, width - band + 1), width);
+        }
+    }
+}
+
+RadialStamp::RadialStamp(int radius, int subsamples, Profile profile)
+    : radius(radius)
+{
+    int size = 2 * radius + 1;
+    weights.resize(static_cast<std::size_t>(size) * size);
+
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            double sum = 0.0;
+            bool inside = false;
+            for (int sy = 0; sy < subsamples; sy++) {
+                for (int sx = 0; sx < subsamples; sx++) {
+                    double px = dx + static_cast<double>(sx) / subsamples;
+                    double py = dy + static_cast<double>(sy) / subsamples;
+                    double distance = std::sqrt(px * px + py * py);
+                    if (distance <= radius) {
+                        sum += profile(distance, radius);
+                        inside = true;
+                    }
+                }
+            }
+            weights[(dy + radius) * size + dx + radius] = inside ? sum : -1.0;
+        }
+    }
+}
+
+double RadialStamp::linearFalloff(double distance, double radius)
+{
+    return 1.0 - distance / radius;
+}
+
+void SplatPass::addSplat(int x, int y, int radius, float intensity, sf::Color color)
+{
+    // A zero radius splat covers no pixel
+    if (radius <= 0) return;
+
+    if (radius >= static_cast<int>(linearStamps.size())) {
+        linearStamps.resize(radius + 1);
+    }
+    if (!linearStamps[radius]) {
+        linearStamps[radius] = std::make_unique<RadialStamp>(radius, 1, &RadialStamp::linearFalloff);
+    }
+    addStamp(x, y, *linearStamps[radius], intensity, color);
+}
+
+void SplatPass::addStamp(int x, int y, const RadialStamp& stamp, float intensity, sf::Color color)
+{
+    splats.push_back(Splat{x, y, &stamp, intensity, color});
+}
+
+void SplatPass::apply(FrameBuffer& frame, const FrameBuffer&, int rowBegin, int rowEnd)
+{
+    int width = frame.getWidth();
+
+    for (const Splat& splat : splats) {
+        int radius = splat.stamp->getRadius();
+        int yBegin = std::max(rowBegin, splat.y - radius);
+        int yEnd = std::min(rowEnd, splat.y + radius + 1);
+        int xBegin = std::max(0, splat.x - radius);
+        int xEnd = std::min(width, splat.x + radius + 1);
+
+        for (int y = yBegin; y < yEnd; y++) {
+            Pixel* row = frame.row(y);
+            int dy = y - splat.y;
+            for (int x = xBegin; x < xEnd; x++) {
+                double weight = splat.stamp->weight(x - splat.x, dy);
+                if (weight >= 0.0) {
+                    row[x] = addScaled(row[x], splat.color, weight * splat.intensity);
+                }
+            }
+        }
+    }
+}
+
+void SlashStrokePass::setColors(const sf::Color (&colors)[bandCount])
+{
+    std::copy(colors, colors + bandCount, bandColors);
+}
+
+void SlashStrokePass::setStroke(sf::Vector2f from, sf::Vector2f to, float strokeHalfWidth)
+{
+    sf::Vector2f delta(to.x - from.x, to.y - from.y);
+    length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+    if (length <= 0.0f) return;
+
+    origin = from;
+    axis = sf::Vector2f(delta.x / length, delta.y / length);
+    halfWidth = strokeHalfWidth;
+}
+
+// The stroke used to be stamped with samples every half pixel across its width,
+// so each pixel received about two blends; keep that weight.
+Pixel SlashStrokePass::shade(Pixel pixel, float offset) const
+{
+    const int samplesPerPixel = 2;
+
+    float dist = std::min(1.0f, std::abs(offset) / halfWidth);
+    int band = std::min(static_cast<int>(dist * bandCount), bandCount - 1);
+    const sf::Color& color = bandColors[band];
+
+    // Sharp fall-off at the edges
+    float fade = dist > 0.8f ? (1.0f - dist) * 5.0f : 1.0f;
+
+    for (int i = 0; i < samplesPerPixel; i++) {
+        if (dist < 0.4f) {
+            // Core is additive for a brighter effect
+            pixel = addScaled(pixel, color, fade);
+        } else {
+            pixel = packColor(
+                static_cast<std::uint8_t>(pixelRed(pixel) * (1.0f - fade) + color.r * fade),
+                static_cast<std::uint8_t>(pixelGreen(pixel) * (1.0f - fade) + color.g * fade),
+                static_cast<std::uint8_t>(pixelBlue(pixel) * (1.0f - fade) + color.b * fade));
+        }
+    }
+    return pixel;
+}
+
+void SlashStrokePass::apply(FrameBuffer& frame, const FrameBuffer&, int rowBegin, int rowEnd)
+{
+    if (length <= 0.0f) return;
+
+    int width = frame.getWidth();
+    sf::Vector2f normal(-axis.y, axis.x);
+
+    // Narrow [low, high] (offsets from the origin's x) to where base + slope * dx lies in [minValue, maxValue]
+    auto clip = [](float base, float slope, float minValue, float maxValue, float& low, float& high) {
+        if (std::abs(slope) < 1e-6f) {
+            if (base < minValue || base > maxValue) high = low - 1.0f;
+            return;
+        }
+        float a = (minValue - base) / slope;
+        float b = (maxValue - base) / slope;
+        low = std::max(low, std::min(a, b));
+        high = std::min(high, std::max(a, b));
+    };
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        // Pixel centers: along = dx * axis.x + dy * axis.y, across = dx * normal.x + dy * normal.y
+        float dy = y + 0.5f - origin.y;
+        float low = -origin.x - 0.5f;
+        float high = width - origin.x - 0.5f;
+        clip(dy * axis.y, axis.x, 0.0f, length, low, high);
+        clip(dy * normal.y, normal.x, -halfWidth, halfWidth, low, high);
+        if (low > high) continue;
+
+        int xBegin = std::max(0, static_cast<int>(std::ceil(low + origin.x - 0.5f)));
+        int xEnd = std::min(width, static_cast<int>(std::floor(high + origin.x - 0.5f)) + 1);
+
+        Pixel* row = frame.row(y);
+        for (int x = xBegin; x < xEnd; x++) {
+            float dx = x + 0.5f - origin.x;
+            row[x] = shade(row[x], dx * normal.x + dy * normal.y);
+        }
+    }
+}
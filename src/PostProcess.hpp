@@ -0,0 +1,127 @@
+// PostProcess.hpp
+#pragma once
+#include "FrameBuffer.hpp"
+#include "ThreadPool.hpp"
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+// One full-screen effect, applied a band of rows at a time. A pass may read
+// the snapshot (the frame as it was before the pass ran) to sample pixels
+// outside its own band; passes that don't are fused with the ones before them.
+class PostProcessPass {
+public:
+    virtual ~PostProcessPass() = default;
+    virtual bool readsSnapshot() const { return false; }
+    virtual void apply(FrameBuffer& frame, const FrameBuffer& snapshot, int rowBegin, int rowEnd) = 0;
+};
+
+// Runs a chain of passes over the frame in row tiles on the worker pool.
+// Each tile goes through every fused pass while it is still in cache.
+class PostProcessor {
+public:
+    static const int tileRows = 16;   // Even, so 2x2 blocks never straddle tiles
+
+    void run(FrameBuffer& frame, ThreadPool& pool, std::initializer_list<PostProcessPass*> passes);
+
+private:
+    FrameBuffer snapshot;             // Persistent, reallocated only on resize
+};
+
+// Blends each 2x2 block with a sample taken against the movement direction
+class DirectionalBlurPass : public PostProcessPass {
+public:
+    void setDirection(float dirX, float dirY, float strength);
+
+    // With no offset each block only samples itself, so it can blend in place
+    bool readsSnapshot() const override { return offsetX != 0 || offsetY != 0; }
+    void apply(FrameBuffer& frame, const FrameBuffer& snapshot, int rowBegin, int rowEnd) override;
+
+private:
+    int offsetX = 0;
+    int offsetY = 0;
+};
+
+// Additive glow fading in from the screen edges; only the edge bands are touched
+class BorderGlowPass : public PostProcessPass {
+public:
+    void setGlow(int bandWidth, sf::Color color, float intensity);
+
+    void apply(FrameBuffer& frame, const FrameBuffer& snapshot, int rowBegin, int rowEnd) override;
+
+private:
+    int band = 40;
+    sf::Color glowColor;
+    float glowIntensity = 0.0f;
+};
+
+// Brightness weights of a round brush, computed once so drawing it needs no
+// sqrt per pixel. Each pixel sums profile(distance) over subsamples x subsamples
+// evenly spaced points, like a brush sampled every 1/subsamples pixel.
+class RadialStamp {
+public:
+    using Profile = double (*)(double distance, double radius);
+
+    RadialStamp(int radius, int subsamples, Profile profile);
+
+    int getRadius() const { return radius; }
+    // Negative where no sample falls inside the brush
+    double weight(int dx, int dy) const { return weights[(dy + radius) * (2 * radius + 1) + dx + radius]; }
+
+    // 1 - distance / radius
+    static double linearFalloff(double distance, double radius);
+
+private:
+    int radius;
+    std::vector<double> weights;   // (2 * radius + 1)^2, row-major
+};
+
+// Additive round sprites (particles, glows). Saturating adds commute, so
+// tiles can draw their part of every splat independently.
+class SplatPass : public PostProcessPass {
+public:
+    struct Splat {
+        int x, y;
+        const RadialStamp* stamp;
+        float intensity;
+        sf::Color color;
+    };
+
+    void clear() { splats.clear(); }
+    // Linear falloff brush; stamps are built on first use of each radius
+    void addSplat(int x, int y, int radius, float intensity, sf::Color color);
+    // Any prebuilt brush; it must outlive the pass run
+    void addStamp(int x, int y, const RadialStamp& stamp, float intensity, sf::Color color);
+    bool empty() const { return splats.empty(); }
+
+    void apply(FrameBuffer& frame, const FrameBuffer& snapshot, int rowBegin, int rowEnd) override;
+
+private:
+    std::vector<Splat> splats;
+    std::vector<std::unique_ptr<RadialStamp>> linearStamps;   // Indexed by radius
+};
+
+// Thick straight stroke with colored bands across its width: an additive core,
+// an opaque body and a faded edge. Rasterized as one span per row, so every
+// pixel is shaded exactly once.
+class SlashStrokePass : public PostProcessPass {
+public:
+    static const int bandCount = 4;
+
+    // Bands from the center line outwards
+    void setColors(const sf::Color (&colors)[bandCount]);
+    // A degenerate stroke (from == to) draws nothing
+    void setStroke(sf::Vector2f from, sf::Vector2f to, float strokeHalfWidth);
+    void disable() { length = 0.0f; }
+
+    void apply(FrameBuffer& frame, const FrameBuffer& snapshot, int rowBegin, int rowEnd) override;
+
+private:
+    sf::Color bandColors[bandCount];
+    sf::Vector2f origin;
+    sf::Vector2f axis;             // Unit vector along the stroke
+    float length = 0.0f;
+    float halfWidth = 0.0f;
+
+    Pixel shade(Pixel pixel, float offset) const;
+};
@@ -0,0 +1,83 @@
+// ProfileOverlay.cpp
+#include "ProfileOverlay.hpp"
+#include <algorithm>
+
+namespace {
+
+// One color per top-level stage; grey for untimed frame time
+Pixel stageColor(ProfileStage stage)
+{
+    switch (stage) {
+        case ProfileStage::Simulate:     return packColor(255, 150, 0);
+        case ProfileStage::Stream:       return packColor(160, 100, 40);
+        case ProfileStage::Trace:        return packColor(0, 210, 255);
+        case ProfileStage::Targets:      return packColor(255, 0, 150);
+        case ProfileStage::ShadeWalls:   return packColor(0, 255, 120);
+        case ProfileStage::Transpose:    return packColor(0, 120, 60);
+        case ProfileStage::Floor:        return packColor(60, 60, 160);
+        case ProfileStage::Sprites:      return packColor(255, 120, 200);
+        case ProfileStage::DashPost:     return packColor(150, 220, 255);
+        case ProfileStage::Sword:        return packColor(0, 255, 255);
+        case ProfileStage::Upload:       return packColor(255, 230, 0);
+        case ProfileStage::Text:         return packColor(255, 255, 255);
+        case ProfileStage::Present:      return packColor(255, 60, 60);
+        default:                         return packColor(120, 120, 120);
+    }
+}
+
+// Half brightness, so the graph stays readable over any scene
+inline Pixel darken(Pixel p)
+{
+    return ((p >> 1) & 0x007f7f7f) | 0xff000000;
+}
+
+} // namespace
+
+void ProfileOverlay::draw(FrameBuffer& frameBuffer, const std::vector<FrameProfile>& frames) const
+{
+    int width = std::min(Profiler::historyLength * barWidth, frameBuffer.getWidth());
+    int height = std::min(graphHeight, frameBuffer.getHeight());
+    if (frames.empty() || width <= 0 || height <= 0) return;
+
+    int left = 0;
+    int bottom = frameBuffer.getHeight() - 1;
+    float pixelsPerMs = graphHeight / graphMs;
+
+    for (int y = bottom - height + 1; y <= bottom; y++) {
+        Pixel* row = frameBuffer.row(y);
+        for (int x = left; x < left + width; x++) row[x] = darken(row[x]);
+    }
+
+    // Newest frame on the right
+    int firstFrame = std::max(0, static_cast<int>(frames.size()) - width / barWidth);
+    for (int i = firstFrame; i < static_cast<int>(frames.size()); i++) {
+        const FrameProfile& profile = frames[i];
+        int x = left + (i - firstFrame) * barWidth;
+        int top = bottom + 1;   // Next free row, growing upwards
+        float coveredMs = 0.0f;
+
+        auto stack = [&](float ms, Pixel color) {
+            int barHeight = std::min(static_cast<int>(ms * pixelsPerMs + 0.5f), top - (bottom - height + 1));
+            if (barHeight <= 0) return;
+            top -= barHeight;
+            frameBuffer.fillRect(x, top, barWidth, barHeight, color);
+        };
+
+        for (int s = 0; s < profileStageCount; s++) {
+            ProfileStage stage = static_cast<ProfileStage>(s);
+            if (!isTopLevelStage(stage)) continue;
+            stack(profile.stageMs[s], stageColor(stage));
+            coveredMs += profile.stageMs[s];
+        }
+        stack(profile.stageMs[static_cast<int>(ProfileStage::Frame)] - coveredMs, stageColor(ProfileStage::Frame));
+    }
+
+    // 16.7 ms and 33.3 ms guides
+    Pixel guide = packColor(255, 255, 255);
+    for (float ms : {1000.0f / 60.0f, 1000.0f / 30.0f}) {
+        int y = bottom - static_cast<int>(ms * pixelsPerMs + 0.5f) + 1;
+        if (y >= bottom - height + 1 && y <= bottom) {
+            for (int x = left; x < left + width; x += 4) frameBuffer.at(x, y) = guide;
+        }
+    }
+}
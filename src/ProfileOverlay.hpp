@@ -0,0 +1,17 @@
+// ProfileOverlay.hpp
+#pragma once
+#include "FrameBuffer.hpp"
+#include "Profiler.hpp"
+#include <vector>
+
+// Frame time graph in the bottom-left corner: one bar per recent frame, stacked
+// by top-level stage, with guide lines at 60 and 30 fps. Time not covered by
+// any stage is drawn in grey on top.
+class ProfileOverlay {
+public:
+    static const int barWidth = 2;
+    static const int graphHeight = 100;
+    static constexpr float graphMs = 100.0f / 3.0f;   // Full height, 30 fps
+
+    void draw(FrameBuffer& frameBuffer, const std::vector<FrameProfile>& frames) const;
+};
@@ -0,0 +1,202 @@
+// Profiler.cpp
+#include "Profiler.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+const char* const stageNames[profileStageCount] = {
+    "frame", "simulate", "stream", "trace", "targets", "shade walls", "transpose", "floor", "sprites",
+    "dash post", "sword", "upload", "text", "present",
+    "trace tile", "wall fill", "sprite fill", "floor tile", "post tile"
+};
+
+std::atomic<std::uint16_t> nextThreadIndex{0};
+
+// Handed out on a thread's first event, so the main thread is usually 0
+std::uint16_t currentThreadIndex()
+{
+    thread_local std::uint16_t index = nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+} // namespace
+
+const char* getProfileStageName(ProfileStage stage)
+{
+    int index = static_cast<int>(stage);
+    return index >= 0 && index < profileStageCount ? stageNames[index] : "unknown";
+}
+
+bool isTopLevelStage(ProfileStage stage)
+{
+    return stage > ProfileStage::Frame && stage < ProfileStage::TraceTile;
+}
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler(defaultCapacity);
+    return profiler;
+}
+
+Profiler::Profiler(std::size_t capacity)
+    : origin(std::chrono::steady_clock::now())
+{
+    // Round up to a power of two so the ring index is a mask
+    std::size_t size = 1;
+    while (size < capacity) size <<= 1;
+    slots.reset(new Slot[size]);
+    mask = size - 1;
+
+    for (auto& total : stageTotals) total.store(0, std::memory_order_relaxed);
+    frames.resize(historyLength);
+}
+
+void Profiler::beginFrame()
+{
+    currentFrame.fetch_add(1, std::memory_order_relaxed);
+    frameStart = now();
+    for (auto& total : stageTotals) total.store(0, std::memory_order_relaxed);
+}
+
+void Profiler::endFrame()
+{
+    if (!isEnabled()) return;
+
+    std::uint64_t end = now();
+    record(ProfileStage::Frame, frameStart, end);
+
+    FrameProfile& profile = frames[framesWritten % historyLength];
+    profile.frame = currentFrame.load(std::memory_order_relaxed);
+    for (int i = 0; i < profileStageCount; i++) {
+        profile.stageMs[i] = stageTotals[i].load(std::memory_order_relaxed) / 1.0e6f;
+    }
+    profile.stageMs[static_cast<int>(ProfileStage::Frame)] = (end - frameStart) / 1.0e6f;
+    framesWritten++;
+}
+
+void Profiler::record(ProfileStage stage, std::uint64_t start, std::uint64_t end)
+{
+    std::uint64_t duration = end > start ? end - start : 0;
+    std::uint64_t info = static_cast<std::uint64_t>(currentFrame.load(std::memory_order_relaxed)) << 32 |
+                         static_cast<std::uint64_t>(currentThreadIndex()) << 8 |
+                         static_cast<std::uint64_t>(stage);
+
+    // Claim a slot; invalidate it while its fields are being replaced
+    std::uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index & mask];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(duration, std::memory_order_relaxed);
+    slot.info.store(info, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+
+    if (isTopLevelStage(stage)) {
+        stageTotals[static_cast<int>(stage)].fetch_add(duration, std::memory_order_relaxed);
+    }
+}
+
+std::vector<ProfileEvent> Profiler::events() const
+{
+    std::uint64_t end = writeIndex.load(std::memory_order_acquire);
+    std::uint64_t capacity = mask + 1;
+    std::uint64_t begin = end > capacity ? end - capacity : 0;
+
+    std::vector<ProfileEvent> result;
+    result.reserve(static_cast<std::size_t>(end - begin));
+    for (std::uint64_t index = begin; index < end; index++) {
+        const Slot& slot = slots[index & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1) continue;  // Unfinished or overwritten
+
+        ProfileEvent event;
+        event.start = slot.start.load(std::memory_order_relaxed);
+        event.duration = slot.duration.load(std::memory_order_relaxed);
+        std::uint64_t info = slot.info.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != index + 1) continue;
+
+        event.frame = static_cast<std::uint32_t>(info >> 32);
+        event.thread = static_cast<std::uint16_t>(info >> 8);
+        event.stage = static_cast<ProfileStage>(info & 0xff);
+        result.push_back(event);
+    }
+    return result;
+}
+
+std::vector<FrameProfile> Profiler::history() const
+{
+    int count = std::min(framesWritten, historyLength);
+    std::vector<FrameProfile> result;
+    result.reserve(count);
+    for (int i = framesWritten - count; i < framesWritten; i++) {
+        result.push_back(frames[i % historyLength]);
+    }
+    return result;
+}
+
+FrameProfile Profiler::lastFrame() const
+{
+    if (framesWritten == 0) return FrameProfile{};
+    return frames[(framesWritten - 1) % historyLength];
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open profile trace: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<ProfileEvent> recorded = events();
+    int threadCount = 0;
+    for (const ProfileEvent& event : recorded) threadCount = std::max(threadCount, event.thread + 1);
+
+    // Complete ("X") events in microseconds, plus a name for each thread row
+    file << "{\"traceEvents\":[\n";
+    file << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (int thread = 0; thread < threadCount; thread++) {
+        std::string name = thread == 0 ? "main" : "worker " + std::to_string(thread);
+        file << (first ? "" : ",\n")
+             << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread
+             << ",\"args\":{\"name\":\"" << name << "\"}}";
+        first = false;
+    }
+    for (const ProfileEvent& event : recorded) {
+        file << (first ? "" : ",\n")
+             << "{\"name\":\"" << getProfileStageName(event.stage) << "\",\"ph\":\"X\",\"pid\":0"
+             << ",\"tid\":" << event.thread
+             << ",\"ts\":" << event.start / 1.0e3
+             << ",\"dur\":" << event.duration / 1.0e3
+             << ",\"args\":{\"frame\":" << event.frame << "}}";
+        first = false;
+    }
+    file << "\n]}\n";
+
+    std::cout << "Wrote " << recorded.size() << " profile events to " << path << std::endl;
+    return static_cast<bool>(file);
+}
+
+bool Profiler::writeCsv(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open profile CSV: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<ProfileEvent> recorded = events();
+    file << "frame,thread,stage,start_us,duration_us\n";
+    file << std::fixed << std::setprecision(3);
+    for (const ProfileEvent& event : recorded) {
+        file << event.frame << ',' << event.thread << ',' << getProfileStageName(event.stage) << ','
+             << event.start / 1.0e3 << ',' << event.duration / 1.0e3 << '\n';
+    }
+
+    std::cout << "Wrote " << recorded.size() << " profile events to " << path << std::endl;
+    return static_cast<bool>(file);
+}
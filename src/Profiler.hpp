@@ -0,0 +1,159 @@
+// Profiler.hpp
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Stage timers are compiled in only when RAYCASTER_PROFILING is 1 (CMake option
+// RAYCASTER_PROFILING). Otherwise PROFILE_SCOPE expands to nothing.
+#ifndef RAYCASTER_PROFILING
+#define RAYCASTER_PROFILING 0
+#endif
+
+// Timed parts of a frame. The top-level stages run one after another on the
+// main thread; the tile stages run on the worker pool inside them.
+enum class ProfileStage : std::uint8_t {
+    Frame,        // Whole frame, recorded by endFrame()
+    Simulate,     // Fixed simulation steps
+    Stream,       // Streaming world: install loaded chunks, move the window
+    Trace,        // DDA for every column
+    Targets,      // Cull, project and sort target sprites; find dash hits
+    ShadeWalls,   // Wall pass over the G-buffer
+    Transpose,    // Column-major buffer back to row-major
+    Floor,        // Floor and ceiling rows around the walls
+    Sprites,      // Target sprites over everything
+    DashPost,     // Dash post-process chain
+    Sword,        // Weapon overlay
+    Upload,       // Framebuffer to GPU texture
+    Text,         // UI text
+    Present,      // Window draw and display
+    TraceTile,    // Worker stages
+    WallFill,
+    SpriteFill,
+    FloorTile,
+    PostTile,
+    Count
+};
+
+const int profileStageCount = static_cast<int>(ProfileStage::Count);
+
+const char* getProfileStageName(ProfileStage stage);
+// Top-level stages add up to (most of) the frame; tile stages overlap them
+bool isTopLevelStage(ProfileStage stage);
+
+struct ProfileEvent {
+    std::uint64_t start;       // ns since the profiler was created
+    std::uint64_t duration;    // ns
+    std::uint32_t frame;
+    std::uint16_t thread;      // Small per-thread index, in order of first use
+    ProfileStage stage;
+};
+
+// Main-thread time spent in each top-level stage of one finished frame
+struct FrameProfile {
+    std::uint32_t frame;
+    float stageMs[profileStageCount];
+};
+
+// Collects timed events from any thread into a fixed-size ring without locks.
+// The newest events overwrite the oldest; export writes what is still there.
+class Profiler {
+public:
+    static const std::size_t defaultCapacity = 1 << 16;   // Events
+    static const int historyLength = 120;                 // Frames kept for the overlay
+
+    static Profiler& instance();
+
+    // Recording is off until enabled, even in a profiling build
+    void setEnabled(bool enabled) { recording.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return recording.load(std::memory_order_relaxed); }
+
+    std::uint64_t now() const
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin).count());
+    }
+
+    // Frame boundaries; call from the main thread, outside any parallel work
+    void beginFrame();
+    void endFrame();
+
+    void record(ProfileStage stage, std::uint64_t start, std::uint64_t end);
+
+    // Events still in the ring, oldest first
+    std::vector<ProfileEvent> events() const;
+    // Finished frames, oldest first (at most historyLength)
+    std::vector<FrameProfile> history() const;
+    // The latest finished frame; all zero before the first
+    FrameProfile lastFrame() const;
+
+    // chrome://tracing / Perfetto JSON, and one event per CSV row
+    bool writeChromeTrace(const std::string& path) const;
+    bool writeCsv(const std::string& path) const;
+
+private:
+    // Every field is its own atomic, so a reader racing a writer that wraps
+    // around sees a stale or half-new event, never undefined behaviour
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};   // Write index + 1 once complete
+        std::atomic<std::uint64_t> start{0};
+        std::atomic<std::uint64_t> duration{0};
+        std::atomic<std::uint64_t> info{0};       // frame << 32 | thread << 8 | stage
+    };
+
+    explicit Profiler(std::size_t capacity);
+
+    std::chrono::steady_clock::time_point origin;
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask;                               // Capacity - 1 (a power of two)
+    std::atomic<std::uint64_t> writeIndex{0};
+    std::atomic<bool> recording{false};
+
+    std::atomic<std::uint32_t> currentFrame{0};
+    std::uint64_t frameStart = 0;
+    std::atomic<std::uint64_t> stageTotals[profileStageCount];  // ns this frame, top-level only
+    std::vector<FrameProfile> frames;               // Ring of historyLength
+    int framesWritten = 0;
+};
+
+// Times its enclosing scope into the profiler
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage)
+        : stage(stage),
+          start(Profiler::instance().isEnabled() ? Profiler::instance().now() : 0)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        Profiler& profiler = Profiler::instance();
+        if (start != 0 && profiler.isEnabled()) {
+            profiler.record(stage, start, profiler.now());
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfileStage stage;
+    std::uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if RAYCASTER_PROFILING
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(ProfileStage::stage)
+#define PROFILE_BEGIN_FRAME() Profiler::instance().beginFrame()
+#define PROFILE_END_FRAME() Profiler::instance().endFrame()
+#else
+#define PROFILE_SCOPE(stage) ((void)0)
+#define PROFILE_BEGIN_FRAME() ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
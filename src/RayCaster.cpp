@@ -1,22 +1,55 @@
 #include "RayCaster.hpp"
+#include "SpanShader.hpp"
+#include "Profiler.hpp"
 #include <cmath>
 #include <cstdint>
+#include <algorithm>
 
-RayCaster::RayCaster(int screenWidth, int screenHeight)
-    : frameTexture(sf::Vector2u(static_cast<unsigned int>(screenWidth), 
-                 static_cast<unsigned int>(screenHeight))),
-      frameSprite(frameTexture),
+// Ring glow of the slash flash: bright edge ring, faint inner ring, clear center
+static double flashRingProfile(double distance, double radius)
+{
+    if (distance > radius * 0.7) {
+        return (1.0 - (distance - radius * 0.7) / (radius * 0.3)) * 0.8;
+    }
+    return distance > radius * 0.5 ? 0.2 : 0.0;
+}
+
+RayCaster::RayCaster(int screenWidth, int screenHeight, bool headless)
+    : outputSize(std::max(1, screenWidth), std::max(1, screenHeight)),
+      texturedWalls(true),
       dashEffectIntensity(0.8f),       // Increased for stronger effect
       dashEffectSpeed(8.0f),           // Faster animation
       dashEffectTimer(0.0f),
       dashStartTime(0.0f),
       dashDuration(0.4f),              // Total duration of dash effect
-      dashActive(false)
+      dashActive(false),
+      pulseTimer(0.0f),
+      positionTrackTimer(0.0f),
+      lastPositionTime(0.0f),
+      interlaced(false),
+      columnMajor(false),
+      packetWidth(getMaxPacketWidth()),
+      profileOverlay(false),
+      incremental(true),
+      frameValid(false),
+      shadedTraceRevision(0),
+      shadedMapRevision(0),
+      shadedReconstructed(false),
+      dirtyRowBegin(0),
+      dirtyRowEnd(0),
+      flashStamp(35, 2, &flashRingProfile)    // Sampled every half pixel
 {
     // The rest of your constructor
-    frameBuffer = sf::Image(sf::Vector2u(static_cast<unsigned int>(screenWidth), 
-                          static_cast<unsigned int>(screenHeight)), 
-                          sf::Color::Black);
+    frameBuffer.resize(screenWidth, screenHeight);
+    camera.setResolution(screenWidth, screenHeight);
+
+    // The texture needs a GPU context, so only create it when we present to a window
+    if (!headless) {
+        frameTexture.emplace(sf::Vector2u(static_cast<unsigned int>(screenWidth), 
+                                          static_cast<unsigned int>(screenHeight)));
+        frameTexture->setSmooth(true);   // Filters the upscale below the output size; 1:1 is unaffected
+        frameSprite.emplace(*frameTexture);
+    }
     
     // Initialize wall colors
     // Cyberpunk/Tron color scheme
@@ -27,6 +60,18 @@ wallColors = {
     sf::Color(0, 255, 120),     // Type 3: Electric green for data streams
     sf::Color(255, 230, 0)      // Type 4: Bright yellow (if you add another wall type)
 };
+
+    // assets/textures/wall<type>.png where present, procedural panels elsewhere
+    wallTextures.load("assets/textures", static_cast<int>(wallColors.size()));
+    
+    // Slash disc bands, Tron colors - blue/cyan theme
+    const sf::Color discColors[SlashStrokePass::bandCount] = {
+        sf::Color(255, 255, 255),    // White core
+        sf::Color(150, 220, 255),    // Light blue
+        sf::Color(30, 150, 255),     // Medium blue
+        sf::Color(5, 50, 150)        // Dark blue edge
+    };
+    slashStroke.setColors(discColors);
     
     // Initialize array for previous positions (for afterimages)
     for (int i = 0; i < 5; i++) {
@@ -45,8 +90,8 @@ float RayCaster::easeOutQuart(float t) {
     return 1.0f - std::pow(1.0f - t, 4.0f);
 }
 
-// Modified drawMovingSlash to accept the isHorizontal parameter
-void RayCaster::drawMovingSlash(float dashProgress, int screenWidth, int screenHeight, 
+// Set up the moving slash (disc body, leading flash and trail) for the dash passes
+void RayCaster::queueMovingSlash(float dashProgress, int screenWidth, int screenHeight, 
     const sf::Vector2f& playerDir, bool isHorizontal)
 {
     // Calculate start and end points for the slash trajectory
@@ -94,14 +139,6 @@ void RayCaster::drawMovingSlash(float dashProgress, int screenWidth, int screenH
     int trailX = startX + static_cast<int>((endX - startX) * trailStartProgress);
     int trailY = startY + static_cast<int>((endY - startY) * trailStartProgress);
 
-    // Tron colors - blue/cyan theme
-    std::vector<sf::Color> discColors = {
-        sf::Color(255, 255, 255),    // White core
-        sf::Color(150, 220, 255),    // Light blue
-        sf::Color(30, 150, 255),     // Medium blue
-        sf::Color(5, 50, 150)        // Dark blue edge
-    };
-
     // Calculate slash direction vector
     float slashDirX = static_cast<float>(currentX - trailX);
     float slashDirY = static_cast<float>(currentY - trailY);
@@ -112,102 +149,15 @@ void RayCaster::drawMovingSlash(float dashProgress, int screenWidth, int screenH
         slashDirY /= length;
     }
 
-    // Perpendicular vector for disc width
-    float perpX = -slashDirY;
-    float perpY = slashDirX;
-
+    // The disc body: one span per row, every pixel shaded once.
     // Disc width - consistent for more disc-like appearance
     float discThickness = 30.0f;
+    slashStroke.setStroke(sf::Vector2f(static_cast<float>(trailX), static_cast<float>(trailY)),
+                          sf::Vector2f(static_cast<float>(currentX), static_cast<float>(currentY)),
+                          discThickness);
 
-    // Draw the main disc shape
-    for (float t = 0; t <= 1.0f; t += 0.01f) {
-        // Position along the slash line
-        float x = trailX + (currentX - trailX) * t;
-        float y = trailY + (currentY - trailY) * t;
-
-        // Create circular disc shape
-        for (float w = -discThickness; w <= discThickness; w += 0.5f) {
-            int drawX = static_cast<int>(x + perpX * w);
-            int drawY = static_cast<int>(y + perpY * w);
-
-            if (drawX >= 0 && drawX < screenWidth && drawY >= 0 && drawY < screenHeight) {
-                // Distance from center of disc line
-                float dist = std::abs(w) / discThickness;
-                dist = std::max(0.0f, std::min(1.0f, dist));
-
-                // Select color based on distance from center
-                int colorIdx = std::min(static_cast<int>(dist * discColors.size()), 
-                            static_cast<int>(discColors.size() - 1));
-                sf::Color discColor = discColors[colorIdx];
-
-                // Create sharp edge for Tron disc effect
-                float fade = 1.0f;
-                if (dist > 0.8f) {
-                    // Sharper fall-off at the edges
-                    fade = (1.0f - dist) * 5.0f;
-                }
-
-                // Get current color and blend
-                sf::Color currentColor = frameBuffer.getPixel({static_cast<unsigned int>(drawX), 
-                                          static_cast<unsigned int>(drawY)});
-
-                // Core is more additive for brighter effect
-                sf::Color finalColor;
-                if (dist < 0.4f) {
-                    finalColor = sf::Color(
-                        static_cast<std::uint8_t>(std::min(255, currentColor.r + static_cast<int>(discColor.r * fade))),
-                        static_cast<std::uint8_t>(std::min(255, currentColor.g + static_cast<int>(discColor.g * fade))),
-                        static_cast<std::uint8_t>(std::min(255, currentColor.b + static_cast<int>(discColor.b * fade)))
-                    );
-                } else {
-                    finalColor = sf::Color(
-                        static_cast<std::uint8_t>(currentColor.r * (1.0f - fade) + discColor.r * fade),
-                        static_cast<std::uint8_t>(currentColor.g * (1.0f - fade) + discColor.g * fade),
-                        static_cast<std::uint8_t>(currentColor.b * (1.0f - fade) + discColor.b * fade)
-                    );
-                }
-
-                frameBuffer.setPixel({static_cast<unsigned int>(drawX), static_cast<unsigned int>(drawY)}, finalColor);
-            }
-        }
-    }
-
-    // Add bright flash at the leading edge of the disc
-    float flashSize = 35.0f;
-    for (float px = -flashSize; px <= flashSize; px += 0.5f) {
-        for (float py = -flashSize; py <= flashSize; py += 0.5f) {
-            int drawX = static_cast<int>(currentX + px);
-            int drawY = static_cast<int>(currentY + py);
-
-            if (drawX >= 0 && drawX < screenWidth && drawY >= 0 && drawY < screenHeight) {
-                float dist = std::sqrt(px*px + py*py);
-                if (dist <= flashSize) {
-                    // Create glowing edge with sharper falloff
-                    float fade = 0.0f;
-                    if (dist > flashSize * 0.7f) {
-                        // Create ring effect at the edge
-                        fade = (1.0f - (dist - flashSize * 0.7f) / (flashSize * 0.3f)) * 0.8f;
-                    } else if (dist > flashSize * 0.5f) {
-                        fade = 0.2f;
-                    }
-
-                    sf::Color flashColor(100, 200, 255); // Tron blue glow
-                    sf::Color currentColor = frameBuffer.getPixel({static_cast<unsigned int>(drawX), 
-                                                          static_cast<unsigned int>(drawY)});
-
-                    // Additive blend for glow
-                    sf::Color finalColor = sf::Color(
-                        static_cast<std::uint8_t>(std::min(255, currentColor.r + static_cast<int>(flashColor.r * fade))),
-                        static_cast<std::uint8_t>(std::min(255, currentColor.g + static_cast<int>(flashColor.g * fade))),
-                        static_cast<std::uint8_t>(std::min(255, currentColor.b + static_cast<int>(flashColor.b * fade)))
-                    );
-
-                    frameBuffer.setPixel({static_cast<unsigned int>(drawX), 
-                                  static_cast<unsigned int>(drawY)}, finalColor);
-                }
-            }
-        }
-    }
+    // Add bright flash at the leading edge of the disc - Tron blue glow
+    dashSplats.addStamp(currentX, currentY, flashStamp, 1.0f, sf::Color(100, 200, 255));
 
     // Add a simple trail of blue light behind the disc (simplified particles)
     int trailPoints = 15; // Fewer trail points for simplicity
@@ -219,49 +169,18 @@ void RayCaster::drawMovingSlash(float dashProgress, int screenWidth, int screenH
         float trailPointX = currentX - slashDirX * length * t;
         float trailPointY = currentY - slashDirY * length * t;
         
-        // Trail size
-        float trailSize = 12.0f * fadeT;
-        
-        // Draw trail point
-        for (float px = -trailSize; px <= trailSize; px += 1.0f) {
-            for (float py = -trailSize; py <= trailSize; py += 1.0f) {
-                int drawX = static_cast<int>(trailPointX + px);
-                int drawY = static_cast<int>(trailPointY + py);
-                
-                if (drawX >= 0 && drawX < screenWidth && drawY >= 0 && drawY < screenHeight) {
-                    float dist = std::sqrt(px*px + py*py);
-                    if (dist <= trailSize) {
-                        // Fade based on distance from center and position in trail
-                        float fade = (1.0f - dist/trailSize) * fadeT * 0.5f;
-                        
-                        // Trail color - blue for Tron effect
-                        sf::Color trailColor(30, 150, 255);
-                        sf::Color currentColor = frameBuffer.getPixel({static_cast<unsigned int>(drawX), 
-                                                              static_cast<unsigned int>(drawY)});
-                        
-                        // Blend
-                        sf::Color finalColor = sf::Color(
-                            static_cast<std::uint8_t>(std::min(255, currentColor.r + static_cast<int>(trailColor.r * fade))),
-                            static_cast<std::uint8_t>(std::min(255, currentColor.g + static_cast<int>(trailColor.g * fade))),
-                            static_cast<std::uint8_t>(std::min(255, currentColor.b + static_cast<int>(trailColor.b * fade)))
-                        );
-                        
-                        frameBuffer.setPixel({static_cast<unsigned int>(drawX), 
-                                      static_cast<unsigned int>(drawY)}, finalColor);
-                    }
-                }
-            }
-        }
+        // Trail size, fading by distance from center and position in trail
+        int trailSize = static_cast<int>(std::lround(12.0f * fadeT));
+        dashSplats.addSplat(static_cast<int>(trailPointX), static_cast<int>(trailPointY), trailSize,
+                            fadeT * 0.5f, sf::Color(30, 150, 255));
     }
 }
 
 // Make sure to update the applyDashEffect function's slash positions to match too
 void RayCaster::applyDashEffect(float dashProgress, float playerDirX, float playerDirY)
 {
-    applySimpleMotionBlur(playerDirX, playerDirY, 0.3f);
-
-    int screenWidth = frameBuffer.getSize().x;
-    int screenHeight = frameBuffer.getSize().y;
+    int screenWidth = frameBuffer.getWidth();
+    int screenHeight = frameBuffer.getHeight();
 
     // Create a direction vector for the slash
     sf::Vector2f playerDir(playerDirX, playerDirY);
@@ -277,50 +196,36 @@ void RayCaster::applyDashEffect(float dashProgress, float playerDirX, float play
         isHorizontal = true;
     }
 
+    // Light motion blur against the view direction on every dash frame
+    dashBlur.setDirection(playerDirX, playerDirY, 0.3f);
+    dashSplats.clear();
+
     // Define slash phases based on progress
     if (dashProgress < 0.15f) {
         float intensity = dashProgress / 0.15f;
 
-        // Edge glow code - blue for Tron effect
-        for (int x = 0; x < screenWidth; x++) {
-            for (int y = 0; y < screenHeight; y++) {
-                // Only affect pixels near the edges
-                float edgeDistance = std::min(
-                    std::min(static_cast<float>(x), static_cast<float>(y)),
-                    std::min(static_cast<float>(screenWidth - x), static_cast<float>(screenHeight - y))
-                );
-
-                if (edgeDistance < 40) {
-                    float fade = (1.0f - edgeDistance / 40.0f) * intensity * 0.5f;
-                    sf::Color currentColor = frameBuffer.getPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)});
-
-                    // Blue Tron-like glow instead of green
-                    sf::Color newColor(
-                        static_cast<std::uint8_t>(std::min(255, currentColor.r + static_cast<int>(30 * fade))),
-                        static_cast<std::uint8_t>(std::min(255, currentColor.g + static_cast<int>(100 * fade))),
-                        static_cast<std::uint8_t>(std::min(255, currentColor.b + static_cast<int>(200 * fade)))
-                    );
-
-                    frameBuffer.setPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)}, newColor);
-                }
-            }
-        }
+        // Edge glow - blue for Tron effect
+        dashGlow.setGlow(40, sf::Color(30, 100, 200), intensity * 0.5f);
 
         // Start a faint moving slash - limit how far it goes
         float adjustedProgress = dashProgress / 0.15f * 0.2f; // Only move 20% into the animation
-        drawMovingSlash(adjustedProgress, screenWidth, screenHeight, playerDir, isHorizontal);
+        queueMovingSlash(adjustedProgress, screenWidth, screenHeight, playerDir, isHorizontal);
+
+        // All passes run fused, tile by tile
+        postProcessor.run(frameBuffer, workerPool, {&dashBlur, &dashGlow, &slashStroke, &dashSplats});
     }
     else if (dashProgress < 0.85f) {
         // Main slash phase - draw the moving slash
         float adjustedProgress = 0.2f + ((dashProgress - 0.15f) / 0.7f) * 0.8f;
-        drawMovingSlash(adjustedProgress, screenWidth, screenHeight, playerDir, isHorizontal);
+        queueMovingSlash(adjustedProgress, screenWidth, screenHeight, playerDir, isHorizontal);
+        postProcessor.run(frameBuffer, workerPool, {&dashBlur, &slashStroke, &dashSplats});
     }
     else {
         // Fade out phase
         float fadeOutProgress = (dashProgress - 0.85f) / 0.15f;
         float fadeOutIntensity = 1.0f - fadeOutProgress;
 
-        drawMovingSlash(1.0f, screenWidth, screenHeight, playerDir, isHorizontal);
+        queueMovingSlash(1.0f, screenWidth, screenHeight, playerDir, isHorizontal);
 
         // Simpler fade-out with fewer particles
         int particleCount = static_cast<int>(10 * fadeOutIntensity);
@@ -369,352 +274,626 @@ void RayCaster::applyDashEffect(float dashProgress, float playerDirX, float play
             float sizeFactor = 0.7f + 0.3f * t;
             int particleSize = static_cast<int>(6 * fadeOutIntensity * sizeFactor);
 
-            for (int px = -particleSize; px <= particleSize; px++) {
-                for (int py = -particleSize; py <= particleSize; py++) {
-                    int x = particleX + px;
-                    int y = particleY + py;
-
-                    if (x >= 0 && x < screenWidth && y >= 0 && y < screenHeight) {
-                        float dist = std::sqrt(px*px + py*py);
-                        if (dist <= particleSize) {
-                            float brightness = (1.0f - dist/particleSize) * fadeOutIntensity;
-                            
-                            sf::Color currentColor = frameBuffer.getPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)});
-                            // Blue Tron colors instead of green
-                            sf::Color particleColor(
-                                static_cast<std::uint8_t>(std::min(255, currentColor.r + static_cast<int>(30 * brightness))),
-                                static_cast<std::uint8_t>(std::min(255, currentColor.g + static_cast<int>(100 * brightness))),
-                                static_cast<std::uint8_t>(std::min(255, currentColor.b + static_cast<int>(200 * brightness)))
-                            );
-                            
-                            frameBuffer.setPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)}, particleColor);
-                        }
-                    }
-                }
-            }
+            // Blue Tron colors instead of green
+            // Additive, so drawing them with the slash's splats keeps the order irrelevant
+            dashSplats.addSplat(particleX, particleY, particleSize, fadeOutIntensity, sf::Color(30, 100, 200));
         }
+
+        postProcessor.run(frameBuffer, workerPool, {&dashBlur, &slashStroke, &dashSplats});
     }
 }
 
-// Simple motion blur that's less intensive
-void RayCaster::applySimpleMotionBlur(float dirX, float dirY, float strength)
+ColumnSpan RayCaster::columnTarget(int x)
 {
-    int screenWidth = frameBuffer.getSize().x;
-    int screenHeight = frameBuffer.getSize().y;
-    
-    // Create a copy of the framebuffer to read from
-    sf::Image frameBufferCopy = frameBuffer;
-    
-    // Apply a simple directional blur (less samples, simpler math)
-    for (int y = 0; y < screenHeight; y += 2) { // Process every other line for performance
-        for (int x = 0; x < screenWidth; x += 2) { // Process every other pixel for performance
-            sf::Color originalColor = frameBufferCopy.getPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)});
-            
-            // Sample just one point in the direction of movement
-            int blurX = x - static_cast<int>(dirX * 3.0f * strength);
-            int blurY = y - static_cast<int>(dirY * 3.0f * strength);
-            
-            if (blurX >= 0 && blurX < screenWidth && blurY >= 0 && blurY < screenHeight) {
-                sf::Color blurColor = frameBufferCopy.getPixel({static_cast<unsigned int>(blurX), static_cast<unsigned int>(blurY)});
-                
-                // Simple blend
-                sf::Color finalColor(
-                    static_cast<std::uint8_t>((originalColor.r * 0.7f) + (blurColor.r * 0.3f)),
-                    static_cast<std::uint8_t>((originalColor.g * 0.7f) + (blurColor.g * 0.3f)),
-                    static_cast<std::uint8_t>((originalColor.b * 0.7f) + (blurColor.b * 0.3f))
-                );
-                
-                frameBuffer.setPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)}, finalColor);
-                
-                // Also set the neighboring pixels to the same color (optimization)
-                if (x + 1 < screenWidth) {
-                    frameBuffer.setPixel({static_cast<unsigned int>(x + 1), static_cast<unsigned int>(y)}, finalColor);
-                }
-                if (y + 1 < screenHeight) {
-                    frameBuffer.setPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y + 1)}, finalColor);
-                }
-                if (x + 1 < screenWidth && y + 1 < screenHeight) {
-                    frameBuffer.setPixel({static_cast<unsigned int>(x + 1), static_cast<unsigned int>(y + 1)}, finalColor);
-                }
-            }
-        }
-    }
+    return columnMajor ? ColumnSpan{columnBuffer.row(x), 1} : frameBuffer.column(x);
 }
-void RayCaster::castRays(const Player& player, const Map& map)
+
+// Texel times wall color, per channel; white texels take the color exactly
+static Pixel tintPixel(Pixel texel, Pixel tint)
 {
-    int screenWidth = frameBuffer.getSize().x;
-    int screenHeight = frameBuffer.getSize().y;
-    
-    sf::Vector2f pos = player.getPosition();
-    sf::Vector2f dir = player.getDirection();
-    sf::Vector2f plane = player.getPlane();
+    return packColor(static_cast<std::uint8_t>((pixelRed(texel) * (pixelRed(tint) + 1)) >> 8),
+                     static_cast<std::uint8_t>((pixelGreen(texel) * (pixelGreen(tint) + 1)) >> 8),
+                     static_cast<std::uint8_t>((pixelBlue(texel) * (pixelBlue(tint) + 1)) >> 8));
+}
 
-    static float pulseTimer = 0.0f;
-    pulseTimer += 0.016f; // Assuming approximately 60 FPS
-    
-    // Store player position for afterimages
-    // MODIFIED: Separate timer for position tracking
-    static float positionTrackTimer = 0.0f;
-    static float lastPositionTime = 0.0f;
-    
-    positionTrackTimer += 0.016f; // Update at 60 FPS
-    if (positionTrackTimer - lastPositionTime >= 0.05f) { // Store position every 50ms
-        // Shift previous positions
-        for (size_t i = previousPlayerPositions.size() - 1; i > 0; i--) {
-            previousPlayerPositions[i] = previousPlayerPositions[i - 1];
+// Grid coordinate in cells to Q16
+static int toGridFixed(float cells)
+{
+    return static_cast<int>(std::lround(cells * 65536.0f));
+}
+
+// Trace every step-th column of [begin, end) into the G-buffer, marching
+// packetWidth neighbouring rays together
+void RayCaster::traceColumns(int begin, int end, int step, const Map& map, HitBuffer& hits)
+{
+    sf::Vector2f pos = camera.getPosition();
+    sf::Vector2f rayDirs[8];
+    RayHit packet[8];
+
+    int x = begin;
+    while (x < end) {
+        // Leftover columns at the end of a tile go one at a time
+        int count = (packetWidth > 1 && (end - x + step - 1) / step >= packetWidth) ? packetWidth : 1;
+
+        for (int lane = 0; lane < count; lane++) {
+            rayDirs[lane] = camera.rayDirection(x + lane * step);
         }
-        previousPlayerPositions[0] = pos;
-        lastPositionTime = positionTrackTimer; // Reset only the position tracking timer
-    }
-    
-    // Clear the framebuffer
-    for (int x = 0; x < screenWidth; x++) {
-        for (int y = 0; y < screenHeight; y++) {
-            frameBuffer.setPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)}, sf::Color::Black);
+
+        if (count == 8) {
+            traceRayPacket8(pos, rayDirs, map, packet);
+        } else if (count == 4) {
+            traceRayPacket4(pos, rayDirs, map, packet);
+        } else {
+            packet[0] = traceRay(pos, rayDirs[0], map);
         }
+
+        for (int lane = 0; lane < count; lane++) {
+            // Where the ray struck the wall face, for texturing
+            const RayHit& hit = packet[lane];
+            const sf::Vector2f& dir = rayDirs[lane];
+            float wallX = hit.side == 0 ? pos.y + hit.distance * dir.y
+                                        : pos.x + hit.distance * dir.x;
+            // The slice height is converted once here; every later pass reads it
+            hits.store(x + lane * step, hit, faceTextureU(hit.side, wallX, dir), camera.lineHeight(hit.distance));
+        }
+
+        x += count * step;
     }
-    
-    // Cyberpunk ceiling - dark with grid effect
-    sf::Color ceilingColor(5, 10, 25); // Very dark blue
-    if ((int)(pos.x * 2 + 0.5) % 2 == 0 || (int)(pos.y * 2 + 0.5) % 2 == 0) {
-        ceilingColor = sf::Color(10, 20, 40); // Slightly lighter for grid effect
+}
+
+// Trace the columns of one parity, or every column for -1. Columns are
+// independent, so tiles of columns are spread across the worker pool.
+void RayCaster::traceParity(int parity, const Map& map, HitBuffer& hits)
+{
+    int screenWidth = hits.size();
+    if (parity < 0) {
+        workerPool.parallelFor(0, screenWidth, columnTileSize, [&](int begin, int end) {
+            PROFILE_SCOPE(TraceTile);
+            traceColumns(begin, end, 1, map, hits);
+        });
+        return;
     }
 
-    // Cyberpunk floor - dark with grid lines
-    sf::Color floorColor(10, 15, 30); // Dark blue
-    if ((int)(pos.x * 2 + 0.5) % 2 == 0 || (int)(pos.y * 2 + 0.5) % 2 == 0) {
-        floorColor = sf::Color(0, 50, 80); // Brighter blue for grid lines
+    // Tiles count traced columns, so they hold as many rays as full ones
+    int count = (screenWidth - parity + 1) / 2;
+    workerPool.parallelFor(0, count, columnTileSize, [&](int begin, int end) {
+        PROFILE_SCOPE(TraceTile);
+        traceColumns(parity + 2 * begin, parity + 2 * end, 2, map, hits);
+    });
+}
+
+// Find the target sprites this frame shows: cull by frustum and walls, project,
+// sort far to near.
+void RayCaster::collectTargets(FrameState& state, const Map& map)
+{
+    const float targetRadius = 0.25f;   // Half the sprite width, in cells
+    const float nearPlane = 0.1f;
+
+    const std::vector<Target>& targets = map.getTargets();
+    const HitBuffer& hits = state.columnHits;
+    int screenWidth = hits.size();
+    state.visibleTargets.clear();
+
+    // traceFrame pointed the camera at this state's pose
+    sf::Vector2f pos = state.position;
+    sf::Vector2f dir = state.direction;
+    sf::Vector2f plane = state.plane;
+    if (screenWidth == 0 || camera.isDegenerate()) return;
+    float halfWidth = camera.toPlaneUnits(targetRadius);
+
+    // Nothing beyond the farthest wall can show, so the view is the triangle
+    // from the camera to the screen edges at that depth
+    float farthest = *std::max_element(hits.distance.begin(), hits.distance.end());
+    sf::Vector2f farLeft = pos + (dir - plane) * farthest;
+    sf::Vector2f farRight = pos + (dir + plane) * farthest;
+    int minX = static_cast<int>(std::floor(std::min({pos.x, farLeft.x, farRight.x}))) - 1;
+    int minY = static_cast<int>(std::floor(std::min({pos.y, farLeft.y, farRight.y}))) - 1;
+    int maxX = static_cast<int>(std::floor(std::max({pos.x, farLeft.x, farRight.x}))) + 1;
+    int maxY = static_cast<int>(std::floor(std::max({pos.y, farLeft.y, farRight.y}))) + 1;
+
+    spriteGrid.update(map);
+    spriteGrid.forEachInRect(minX, minY, maxX, maxY, [&](int index) {
+        const Target& target = targets[index];
+
+        // Into camera space: depth along the view, cameraX along the camera plane
+        float depth, cameraX;
+        camera.toCameraSpace(sf::Vector2f(target.x + 0.5f, target.y + 0.5f), depth, cameraX);
+        if (depth < nearPlane || depth >= farthest) return;
+
+        VisibleTarget sprite;
+        sprite.index = index;
+        sprite.distance = depth;
+        sprite.lineHeight = camera.lineHeight(depth);
+        sprite.left = camera.projectColumn(cameraX - halfWidth, depth);
+        sprite.right = camera.projectColumn(cameraX + halfWidth, depth);
+
+        // Clip to the screen, then drop the columns at either end a wall hides
+        int first = std::max(0, sprite.left);
+        int last = std::min(screenWidth, sprite.right) - 1;
+        while (first <= last && hits.distance[first] <= depth) first++;
+        while (last >= first && hits.distance[last] <= depth) last--;
+        if (first > last) return;
+
+        sprite.firstColumn = first;
+        sprite.lastColumn = last;
+        state.visibleTargets.push_back(sprite);
+    });
+
+    // Painter's order; the index breaks ties so the order never depends on the grid
+    std::sort(state.visibleTargets.begin(), state.visibleTargets.end(),
+              [](const VisibleTarget& a, const VisibleTarget& b) {
+                  return a.distance != b.distance ? a.distance > b.distance : a.index < b.index;
+              });
+}
+
+// Wall pass over columns [begin, end): reads depth, side and wall type
+void RayCaster::shadeWalls(int begin, int end, int screenHeight, const HitBuffer& hits)
+{
+    PROFILE_SCOPE(WallFill);
+    for (int x = begin; x < end; x++) {
+        renderWalls(columnTarget(x), hits, x, screenHeight);
     }
-    
-    // Cast rays for each vertical column
-    for (int x = 0; x < screenWidth; x++)
-    {
-        // Calculate ray position and direction
-        float cameraX = 2 * x / static_cast<float>(screenWidth) - 1; // x-coordinate in camera space
-        sf::Vector2f rayDir(
-            dir.x + plane.x * cameraX,
-            dir.y + plane.y * cameraX
-        );
-        
-        // Which box of the map we're in
-        int mapX = static_cast<int>(pos.x);
-        int mapY = static_cast<int>(pos.y);
-        
-        // Length of ray from current position to next x or y-side
-        sf::Vector2f sideDist;
-        
-        // Length of ray from one x or y-side to next x or y-side
-        sf::Vector2f deltaDist(
-            std::abs(1 / rayDir.x),
-            std::abs(1 / rayDir.y)
-        );
-        
-        // What direction to step in x or y direction (either +1 or -1)
-        int stepX, stepY;
-        
-        // Calculate step and initial sideDist
-        if (rayDir.x < 0)
-        {
-            stepX = -1;
-            sideDist.x = (pos.x - mapX) * deltaDist.x;
-        }
-        else
-        {
-            stepX = 1;
-            sideDist.x = (mapX + 1.0f - pos.x) * deltaDist.x;
-        }
-        
-        if (rayDir.y < 0)
-        {
-            stepY = -1;
-            sideDist.y = (pos.y - mapY) * deltaDist.y;
-        }
-        else
-        {
-            stepY = 1;
-            sideDist.y = (mapY + 1.0f - pos.y) * deltaDist.y;
+}
+
+// Sprite pass over columns [begin, end), far to near over the finished walls,
+// floor and ceiling. Each column is depth tested against its wall.
+void RayCaster::shadeSprites(int begin, int end, const FrameState& state, const Map& map)
+{
+    PROFILE_SCOPE(SpriteFill);
+    const std::vector<Target>& targets = map.getTargets();
+    const HitBuffer& hits = state.columnHits;
+
+    for (const VisibleTarget& sprite : state.visibleTargets) {
+        int first = std::max(begin, sprite.firstColumn);
+        int last = std::min(end - 1, sprite.lastColumn);
+        for (int x = first; x <= last; x++) {
+            if (sprite.distance < hits.distance[x]) {
+                renderSprite(frameBuffer.column(x), sprite, targets[sprite.index], x);
+            }
         }
-        
-        bool hit = false;      // Was a wall hit?
-        bool targetHit = false; // Was a target hit?
-        int side;              // Was a NS or a EW wall hit?
-        int wallType = 0;      // What type of wall was hit?
-        float targetDist = 0;  // Distance to target if hit
-        int targetX = 0, targetY = 0; 
-        
-        while (!hit)
-        {
-            // Jump to next map square, either in x-direction, or in y-direction
-            if (sideDist.x < sideDist.y)
+    }
+}
+
+// Work out this frame's wall and target colors once, instead of per column
+void RayCaster::buildPalette(bool dashing)
+{
+    // One entry per known wall type and side, plus one for unknown types
+    palette.walls.resize((wallColors.size() + 1) * 2);
+
+    for (size_t type = 0; type <= wallColors.size(); type++) {
+        for (int side = 0; side < 2; side++) {
+            // Choose wall color based on wall type
+            sf::Color color;
+            if (type < wallColors.size())
             {
-                sideDist.x += deltaDist.x;
-                mapX += stepX;
-                side = 0;
+                color = wallColors[type];
             }
             else
             {
-                sideDist.y += deltaDist.y;
-                mapY += stepY;
-                side = 1;
+                color = sf::Color::Magenta; // Default for unknown wall types
             }
             
-            // Check if ray has hit a wall
-            wallType = map.getValueAt(mapX, mapY);
-            if (wallType > 0)
+            // Make color darker for y-sides
+            if (side == 1)
             {
-                hit = true;
+                color.r = static_cast<std::uint8_t>(static_cast<float>(color.r) * 0.7f);
+                color.g = static_cast<std::uint8_t>(static_cast<float>(color.g) * 0.7f);
+                color.b = static_cast<std::uint8_t>(static_cast<float>(color.b) * 0.7f);
+
+                float pulseEffect = 0.15f * sin(pulseTimer * 2.0f) + 0.85f;
+                color.r = static_cast<uint8_t>(std::min(255, int(color.r * pulseEffect)));
+                color.g = static_cast<uint8_t>(std::min(255, int(color.g * pulseEffect)));
+                color.b = static_cast<uint8_t>(std::min(255, int(color.b * pulseEffect)));
             }
-            if (map.isTarget(mapX, mapY) && !targetHit) {
-                targetHit = true;
-                targetX = mapX;
-                targetY = mapY;
+
+            // Apply a light green tinge if player is dashing (optimized - only modify the wall rendering)
+            if (dashing) {
+                // Calculate a pulsing effect for the dash
+                float pulse = 0.5f + 0.5f * std::sin(dashEffectTimer * dashEffectSpeed);
                 
-                // Calculate distance to target
-                if (side == 0) {
-                    targetDist = (mapX - pos.x + (1 - stepX) / 2) / rayDir.x;
-                } else {
-                    targetDist = (mapY - pos.y + (1 - stepY) / 2) / rayDir.y;
-                }
+                // Add a green tinge to the wall color directly during rendering
+                color.g = static_cast<std::uint8_t>(std::min(255, color.g + static_cast<int>(40 * pulse)));
+                
+                // Add a bit of brightness for a glow effect too
+                color.r = static_cast<std::uint8_t>(std::min(255, color.r + static_cast<int>(20 * pulse)));
+                color.b = static_cast<std::uint8_t>(std::min(255, color.b + static_cast<int>(20 * pulse)));
             }
+
+            palette.walls[type * 2 + side] = packColor(color);
         }
-        
-        // Calculate distance projected on camera direction
-        float perpWallDist;
-        if (side == 0)
-        {
-            perpWallDist = (mapX - pos.x + (1 - stepX) / 2) / rayDir.x;
-        }
-        else
-        {
-            perpWallDist = (mapY - pos.y + (1 - stepY) / 2) / rayDir.y;
-        }
-        
-        // Calculate height of line to draw on screen
-        int lineHeight = static_cast<int>(screenHeight / perpWallDist);
-        
-        // Calculate lowest and highest pixel to fill in current stripe
-        int drawStart = -lineHeight / 2 + screenHeight / 2;
-        if (drawStart < 0) drawStart = 0;
-        
-        int drawEnd = lineHeight / 2 + screenHeight / 2;
-        if (drawEnd >= screenHeight) drawEnd = screenHeight - 1;
-        
-        // Choose wall color based on wall type
-        sf::Color color;
-        if (wallType < static_cast<int>(wallColors.size()))
-        {
-            color = wallColors[wallType];
+    }
+
+    // Gray for hit targets, a pulsing orange/yellow glow for active ones
+    palette.hitTarget = packColor(sf::Color(100, 100, 100));
+    float targetPulse = 0.5f + 0.5f * sin(pulseTimer * 3.0f);
+    palette.activeTarget = packColor(sf::Color(
+        255, 
+        static_cast<uint8_t>(100 + 155 * targetPulse), 
+        0
+    ));
+}
+
+// Palette slot of a column's wall; unknown wall types share the last one
+size_t RayCaster::wallSlot(const HitBuffer& hits, int x) const
+{
+    size_t type = std::min(static_cast<size_t>(hits.wallType[x]), wallColors.size());
+    return type * 2 + (hits.side[x] == 1 ? 1 : 0);
+}
+
+Pixel RayCaster::targetPixel(const Target& target) const
+{
+    return target.hit ? palette.hitTarget : palette.activeTarget;
+}
+
+// Does frameBuffer still show this view of this map? Then only colors can have changed.
+bool RayCaster::canReuseFrame(const FrameState& state, const Map& map) const
+{
+    // Estimated columns are traced for real once the camera rests, so a
+    // frame shaded from them is never kept
+    return incremental && frameValid && !state.dashing && !profileOverlay && !shadedReconstructed &&
+           static_cast<int>(state.columnHits.size()) == frameBuffer.getWidth() &&
+           state.position == shadedPosition &&
+           state.direction == shadedDirection &&
+           state.plane == shadedPlane &&
+           state.mapRevision == shadedTraceRevision &&
+           map.getRevision() == shadedMapRevision;
+}
+
+// Find the columns whose wall or sprite color differs from the shaded frame,
+// and the rows they cover
+void RayCaster::collectDirtyColumns(const FrameState& state, const Map& map, int screenHeight)
+{
+    bool activeChanged = palette.activeTarget != shadedPalette.activeTarget;
+    bool hitChanged = palette.hitTarget != shadedPalette.hitTarget;
+
+    const HitBuffer& hits = state.columnHits;
+    columnDirty.assign(hits.size(), 0);
+    dirtyRowBegin = screenHeight;
+    dirtyRowEnd = 0;
+
+    for (int x = 0; x < hits.size(); x++) {
+        size_t slot = wallSlot(hits, x);
+        if (palette.walls[slot] == shadedPalette.walls[slot]) continue;
+
+        columnDirty[x] = 1;
+        int start, end;
+        camera.spanRows(hits.lineHeight[x], start, end);
+        if (start < end) {
+            dirtyRowBegin = std::min(dirtyRowBegin, start);
+            dirtyRowEnd = std::max(dirtyRowEnd, end + 1);
         }
-        else
-        {
-            color = sf::Color::Magenta; // Default for unknown wall types
+    }
+
+    for (const VisibleTarget& sprite : state.visibleTargets) {
+        bool changed = map.getTargets()[sprite.index].hit ? hitChanged : activeChanged;
+        if (!changed) continue;
+
+        std::fill(columnDirty.begin() + sprite.firstColumn, columnDirty.begin() + sprite.lastColumn + 1, 1);
+        int start, end;
+        camera.spanRows(sprite.lineHeight, start, end);
+        if (start < end) {
+            dirtyRowBegin = std::min(dirtyRowBegin, start);
+            dirtyRowEnd = std::max(dirtyRowEnd, end + 1);
         }
-        
-        // Make color darker for y-sides
-        if (side == 1)
-        {
-            color.r = static_cast<std::uint8_t>(static_cast<float>(color.r) * 0.7f);
-            color.g = static_cast<std::uint8_t>(static_cast<float>(color.g) * 0.7f);
-            color.b = static_cast<std::uint8_t>(static_cast<float>(color.b) * 0.7f);
-
-        float pulseEffect = 0.15f * sin(pulseTimer * 2.0f) + 0.85f;
-        color.r = static_cast<uint8_t>(std::min(255, int(color.r * pulseEffect)));
-        color.g = static_cast<uint8_t>(std::min(255, int(color.g * pulseEffect)));
-        color.b = static_cast<uint8_t>(std::min(255, int(color.b * pulseEffect)));
-                }
-
-        // Apply a light green tinge if player is dashing (optimized - only modify the wall rendering)
-        if (player.getIsDashing()) {
-            // Calculate a pulsing effect for the dash
-            float pulse = 0.5f + 0.5f * std::sin(dashEffectTimer * dashEffectSpeed);
-            
-            // Add a green tinge to the wall color directly during rendering
-            color.g = static_cast<std::uint8_t>(std::min(255, color.g + static_cast<int>(40 * pulse)));
-            
-            // Add a bit of brightness for a glow effect too
-            color.r = static_cast<std::uint8_t>(std::min(255, color.r + static_cast<int>(20 * pulse)));
-            color.b = static_cast<std::uint8_t>(std::min(255, color.b + static_cast<int>(20 * pulse)));
+    }
+
+    dirtyColumns.clear();
+    for (int x = 0; x < hits.size(); x++) {
+        if (columnDirty[x]) dirtyColumns.push_back(x);
+    }
+
+    if (dirtyRowBegin >= dirtyRowEnd) {
+        dirtyRowBegin = dirtyRowEnd = 0;
+    }
+}
+
+// Draw the wall stripe of one column
+void RayCaster::renderWalls(ColumnSpan column, const HitBuffer& hits, int x, int screenHeight)
+{
+    // Lowest and highest pixel to fill in current stripe
+    int drawStart, drawEnd;
+    camera.spanRows(hits.lineHeight[x], drawStart, drawEnd);
+
+    if (drawStart >= drawEnd) return;
+
+    // Glow: brightness peaks at 1.3x in the middle of the wall and falls off
+    // quadratically towards the top and bottom
+    Pixel color = palette.walls[wallSlot(hits, x)];
+    SpanProfile glow = makeSpanProfile(drawStart, drawEnd, 1.3f, 0.3f);
+    if (!texturedWalls) {
+        shadeSpan(&column[drawStart], column.stride, drawStart, drawEnd, color, glow);
+        return;
+    }
+
+    // The mip level whose texel rows best match the slice height, then the
+    // texel column under the hit point
+    int lineHeight = hits.lineHeight[x];
+    int level = WallTextureAtlas::levelFor(lineHeight);
+    int size = WallTextureAtlas::levelSize(level);
+    int u = std::min(size - 1, static_cast<int>(hits.textureU[x] * size));
+    const Pixel* texels = wallTextures.column(wallTextures.textureFor(hits.wallType[x]), level, u);
+
+    // Tint the strip once instead of every pixel
+    Pixel strip[WallTextureAtlas::textureSize];
+    for (int v = 0; v < size; v++) {
+        strip[v] = tintPixel(texels[v], color);
+    }
+
+    // Texel row of the first drawn pixel, counted from the unclipped top of the slice
+    int wallTop = screenHeight / 2 - lineHeight / 2;
+    int vStep = (size << 16) / lineHeight;
+    int vStart = static_cast<int>(static_cast<std::int64_t>(drawStart - wallTop) * vStep);
+    shadeTexturedSpan(&column[drawStart], column.stride, drawStart, drawEnd, strip, vStart, vStep, glow);
+}
+
+// Draw one column of a target sprite: a glowing pillar, brightest along its
+// axis and in the middle
+void RayCaster::renderSprite(ColumnSpan column, const VisibleTarget& sprite, const Target& target, int x)
+{
+    // Lowest and highest pixel to fill for target
+    int targetDrawStart, targetDrawEnd;
+    camera.spanRows(sprite.lineHeight, targetDrawStart, targetDrawEnd);
+
+    if (targetDrawStart >= targetDrawEnd) return;
+
+    // Across the sprite: full brightness on its axis, 35% at the rim
+    float across = (x + 0.5f - sprite.left) / static_cast<float>(std::max(1, sprite.right - sprite.left)) * 2.0f - 1.0f;
+    float shade = 0.35f + 0.65f * std::max(0.0f, 1.0f - across * across);
+
+    // Along it: full color in the middle, falling off quadratically to black at the ends
+    shadeSpan(&column[targetDrawStart], column.stride, targetDrawStart, targetDrawEnd,
+              targetPixel(target), makeSpanProfile(targetDrawStart, targetDrawEnd, shade, 4.0f * shade));
+
+    // Add point value number in the center of the target. Only the middle
+    // 10% can qualify, so just scan that band.
+    int targetLength = targetDrawEnd - targetDrawStart;
+    int bandStart = std::max(targetDrawStart, targetDrawStart + static_cast<int>(targetLength * 0.45f) - 1);
+    int bandEnd = std::min(targetDrawEnd, targetDrawStart + static_cast<int>(targetLength * 0.55f) + 2);
+
+    // Simple way to show the value - alternating colors based on point value
+    int points = target.points;
+    Pixel markerColor = packColor((points / 10) % 2 == 0 ? sf::Color::White : sf::Color::Black);
+
+    for (int y = bandStart; y < bandEnd; y++) {
+        float targetVPos = (y - targetDrawStart) / static_cast<float>(targetLength);
+        float distFromCenter = std::abs(targetVPos - 0.5f) * 2.0f;
+        float circleEffect = 1.0f - distFromCenter * distFromCenter;
+
+        if (targetVPos > 0.45f && targetVPos < 0.55f && circleEffect > 0.8f) {
+            column[y] = markerColor;
         }
+    }
+}
 
-    for (int y = drawStart; y < drawEnd; y++) {
-        // Original wall color
-        sf::Color pixelColor = color;   
-        // Add glow effect based on distance from center of wall
-        float distFromCenter = std::abs((y - (drawStart + (drawEnd - drawStart) / 2.0f)) / (drawEnd - drawStart));
-        float glowIntensity = 0.3f * (1.0f - distFromCenter * distFromCenter);
-        
-        // Enhance the color's brightness for glow effect
-        pixelColor.r = static_cast<uint8_t>(std::min(255, int(pixelColor.r * (1 + glowIntensity))));
-        pixelColor.g = static_cast<uint8_t>(std::min(255, int(pixelColor.g * (1 + glowIntensity))));
-        pixelColor.b = static_cast<uint8_t>(std::min(255, int(pixelColor.b * (1 + glowIntensity))));
-        
-        frameBuffer.setPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)}, pixelColor);
+// Rows each column's wall covers, as the floor pass needs them
+void RayCaster::collectWallExtents(const HitBuffer& hits, int screenWidth, int screenHeight)
+{
+    floorStarts.resize(screenWidth);
+    ceilingStarts.resize(screenWidth);
+
+    for (int x = 0; x < screenWidth; x++) {
+        // The span is centred on the horizon, so an empty one still splits
+        // the column into ceiling and floor there
+        int top, bottom;
+        camera.spanRows(hits.lineHeight[x], top, bottom);
+        floorStarts[x] = bottom;
+        ceilingStarts[x] = screenHeight - top;
     }
-    if (targetHit) {
-        // Calculate height of target to draw on screen
-        int targetHeight = static_cast<int>(screenHeight / targetDist);
-        
-        // Calculate lowest and highest pixel to fill for target
-        int targetDrawStart = -targetHeight / 2 + screenHeight / 2;
-        if (targetDrawStart < 0) targetDrawStart = 0;
-        
-        int targetDrawEnd = targetHeight / 2 + screenHeight / 2;
-        if (targetDrawEnd >= screenHeight) targetDrawEnd = screenHeight - 1;
-        
-        // Choose target color - use something eye-catching
-        sf::Color targetColor;
-        if (map.isHitTarget(targetX, targetY)) {
-            targetColor = sf::Color(100, 100, 100); // Gray for hit targets
+}
+
+// Cast the floor and ceiling for screen rows [rowBegin, rowEnd). Each row lies
+// at one distance, so the grid position steps by a constant amount per pixel.
+void RayCaster::renderFloorAndCeiling(int rowBegin, int rowEnd, const FrameState& state)
+{
+    PROFILE_SCOPE(FloorTile);
+    int screenWidth = static_cast<int>(floorStarts.size());
+    int screenHeight = frameBuffer.getHeight();
+    int horizon = screenHeight / 2;
+
+    // Cyberpunk floor and ceiling: dark blue with brighter grid lines on the
+    // cell edges, fading into the base color with distance
+    const sf::Color floorColor(10, 15, 30);
+    const sf::Color floorLineColor(0, 50, 80);
+    const sf::Color ceilingColor(5, 10, 25);
+    const sf::Color ceilingLineColor(10, 20, 40);
+    const float fadeDistance = 12.0f;
+    const float minLineWidth = 0.04f;   // Cells
+
+    // Rays through the left and right screen edges
+    sf::Vector2f rayLeft = state.direction - state.plane;
+    sf::Vector2f rayRight = state.direction + state.plane;
+
+    // Only the fractional part shows, so keep coordinates small (and in Q16
+    // range on big maps) by dropping the cell the camera is in
+    sf::Vector2f origin(state.position.x - std::floor(state.position.x),
+                        state.position.y - std::floor(state.position.y));
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        bool floor = y >= horizon;
+
+        float rowDistance = camera.getRowDistance(y);
+
+        float stepX = rowDistance * (rayRight.x - rayLeft.x) / screenWidth;
+        float stepY = rowDistance * (rayRight.y - rayLeft.y) / screenWidth;
+
+        // Lines at least ~1.5 pixels wide so distant rows don't shimmer
+        float pixelCells = std::sqrt(stepX * stepX + stepY * stepY);
+        float lineWidth = std::min(0.5f, std::max(minLineWidth, 1.5f * pixelCells));
+
+        // Centre the lines on the cell edges
+        float startX = origin.x + rowDistance * rayLeft.x + 0.5f * lineWidth;
+        float startY = origin.y + rowDistance * rayLeft.y + 0.5f * lineWidth;
+
+        float fade = std::min(1.0f, rowDistance / fadeDistance);
+        const sf::Color& base = floor ? floorColor : ceilingColor;
+        const sf::Color& line = floor ? floorLineColor : ceilingLineColor;
+        Pixel lineColor = packColor(
+            static_cast<std::uint8_t>(line.r + (base.r - line.r) * fade),
+            static_cast<std::uint8_t>(line.g + (base.g - line.g) * fade),
+            static_cast<std::uint8_t>(line.b + (base.b - line.b) * fade));
+
+        // The ceiling counts rows up from the bottom so one test serves both
+        const int* rowStarts = floor ? floorStarts.data() : ceilingStarts.data();
+        int row = floor ? y : screenHeight - 1 - y;
+
+        shadeGridRow(frameBuffer.row(y), screenWidth, rowStarts, row,
+                     toGridFixed(startX), toGridFixed(startY), toGridFixed(stepX), toGridFixed(stepY),
+                     toGridFixed(lineWidth), packColor(base), lineColor);
+    }
+}
+
+void RayCaster::traceFrame(const Player& player, const Map& map, FrameState& state)
+{
+    int screenWidth = frameBuffer.getWidth();
+    sf::Vector2f previousPosition = state.position;
+    sf::Vector2f previousDirection = state.direction;
+    sf::Vector2f previousPlane = state.plane;
+
+    // Hits of the same map at the same resolution can be kept or reprojected
+    bool sameHits = static_cast<int>(state.columnHits.size()) == screenWidth &&
+                    state.screenHeight == frameBuffer.getHeight() &&
+                    state.mapRevision == map.getRevision();
+    bool samePose = state.position == player.getPosition() &&
+                    state.direction == player.getDirection() &&
+                    state.plane == player.getPlane();
+
+    // The same pose in the same map traces the same hits; keep them unless
+    // some were only estimated
+    bool unchanged = incremental && sameHits && samePose && !state.reconstructed;
+
+    state.position = player.getPosition();
+    state.direction = player.getDirection();
+    state.plane = player.getPlane();
+    state.mapRevision = map.getRevision();
+    state.screenHeight = frameBuffer.getHeight();
+    state.dashing = player.getIsDashing();
+    state.columnHits.resize(screenWidth);
+    camera.setView(state.position, state.direction, state.plane);
+
+    HitBuffer& hits = state.columnHits;
+    if (!unchanged) {
+        PROFILE_SCOPE(Trace);
+        if (!interlaced || !sameHits || screenWidth < 2) {
+            traceParity(-1, map, hits);
+            state.reconstructed = false;
+        } else if (samePose && state.reconstructed) {
+            // The camera stopped: trace the estimated half and the hits are exact again
+            state.tracedParity ^= 1;
+            traceParity(state.tracedParity, map, hits);
+            state.reconstructed = false;
         } else {
-            // Pulsing effect for active targets
-            float targetPulse = 0.5f + 0.5f * sin(pulseTimer * 3.0f);
-            targetColor = sf::Color(
-                255, 
-                static_cast<uint8_t>(100 + 155 * targetPulse), 
-                0
-            ); // Orange/yellow glow
+            // Trace the half that was estimated last frame and estimate the
+            // half traced then, from its hits moved into this view
+            reconstructor.reproject(hits, state.reconstructed ? state.tracedParity : -1,
+                                    previousPosition, previousDirection, previousPlane, camera);
+            state.tracedParity ^= 1;
+            traceParity(state.tracedParity, map, hits);
+
+            int estimated = state.tracedParity ^ 1;
+            workerPool.parallelFor(0, screenWidth, columnTileSize, [&](int begin, int end) {
+                reconstructor.reconstruct(begin, end, estimated, hits, camera);
+            });
+            state.reconstructed = true;
         }
-        
-        // Make target appear as a vertical cylinder/column
-        for (int y = targetDrawStart; y < targetDrawEnd; y++) {
-            // Calculate vertical position on the target (0 to 1)
-            float targetVPos = (y - targetDrawStart) / static_cast<float>(targetDrawEnd - targetDrawStart);
-            
-            // Create a circular pattern on the target
-            float distFromCenter = std::abs(targetVPos - 0.5f) * 2.0f;
-            float circleEffect = 1.0f - distFromCenter * distFromCenter;
-            circleEffect = std::max(0.0f, circleEffect);
-            
-            // Apply circular pattern to color
-            sf::Color pixelColor = targetColor;
-            pixelColor.r = static_cast<uint8_t>(std::min(255, int(pixelColor.r * circleEffect)));
-            pixelColor.g = static_cast<uint8_t>(std::min(255, int(pixelColor.g * circleEffect)));
-            pixelColor.b = static_cast<uint8_t>(std::min(255, int(pixelColor.b * circleEffect)));
-            
-            // Only draw if the target is in front of the wall at this position
-            float wallDist = perpWallDist;
-            if (targetDist < wallDist || (wallDist == 0)) {
-                // Add point value number in the center of the target
-                if (targetVPos > 0.45f && targetVPos < 0.55f && circleEffect > 0.8f) {
-                    // Get point value
-                    int points = map.getTargetPoints(targetX, targetY);
-                    // Simple way to show the value - alternating colors based on point value
-                    if ((points / 10) % 2 == 0) {
-                        pixelColor = sf::Color::White;
-                    } else {
-                        pixelColor = sf::Color::Black;
-                    }
-                }
-                
-                frameBuffer.setPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)}, pixelColor);
-            }
+    }
+
+    PROFILE_SCOPE(Targets);
+    collectTargets(state, map);
+}
+
+void RayCaster::castRays(const Player& player, const Map& map, float deltaTime)
+{
+    traceFrame(player, map, frameState);
+    renderFrame(frameState, player, map, deltaTime);
+}
+
+void RayCaster::renderFrame(const FrameState& state, const Player& player, const Map& map, float deltaTime)
+{
+    int screenWidth = std::min(frameBuffer.getWidth(), static_cast<int>(state.columnHits.size()));
+    int screenHeight = frameBuffer.getHeight();
+    const HitBuffer& hits = state.columnHits;
+    
+    sf::Vector2f pos = state.position;
+
+    pulseTimer += deltaTime;
+    
+    // Store player position for afterimages
+    // MODIFIED: Separate timer for position tracking
+    positionTrackTimer += deltaTime;
+    if (positionTrackTimer - lastPositionTime >= 0.05f) { // Store position every 50ms
+        // Shift previous positions
+        for (size_t i = previousPlayerPositions.size() - 1; i > 0; i--) {
+            previousPlayerPositions[i] = previousPlayerPositions[i - 1];
         }
+        previousPlayerPositions[0] = pos;
+        lastPositionTime = positionTrackTimer; // Reset only the position tracking timer
+    }
+    
+    buildPalette(state.dashing);
+
+    // Shade each vertical column's wall from the G-buffer. Tiles of columns
+    // are spread across the worker pool; the output matches a serial loop.
+    bool reuse = canReuseFrame(state, map);
+    if (reuse) {
+        // Same view of the same map: redraw only the columns whose colors
+        // changed (pulsing walls and targets) over the previous frame
+        collectDirtyColumns(state, map, screenHeight);
+        PROFILE_SCOPE(ShadeWalls);
+        workerPool.parallelFor(0, static_cast<int>(dirtyColumns.size()), columnTileSize, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                shadeWalls(dirtyColumns[i], dirtyColumns[i] + 1, screenHeight, hits);
+            }
+        });
+    } else {
+        // No clear: the floor and ceiling pass below fills every pixel the
+        // walls leave
+        dirtyRowBegin = 0;
+        dirtyRowEnd = screenHeight;
+        PROFILE_SCOPE(ShadeWalls);
+        workerPool.parallelFor(0, screenWidth, columnTileSize, [&](int begin, int end) {
+            shadeWalls(begin, end, screenHeight, hits);
+        });
+    }
+
+    // Transpose the changed rows back to row-major for post effects and presentation
+    if (columnMajor && hasFrameChanged()) {
+        PROFILE_SCOPE(Transpose);
+        workerPool.parallelFor(dirtyRowBegin, dirtyRowEnd, transposeTileSize, [&](int begin, int end) {
+            transposeFrame(columnBuffer, frameBuffer, begin, end);
+        });
+    }
+
+    // Floor and ceiling around the walls, one row at a time. A reused
+    // row-major frame still has them; transposed rows need them again.
+    bool floorCast = !reuse || (columnMajor && hasFrameChanged());
+    if (floorCast) {
+        PROFILE_SCOPE(Floor);
+        collectWallExtents(hits, screenWidth, screenHeight);
+        workerPool.parallelFor(dirtyRowBegin, dirtyRowEnd, floorTileSize, [&](int begin, int end) {
+            renderFloorAndCeiling(begin, end, state);
+        });
     }
 
+    // Target sprites on top. After a floor pass every column may have lost
+    // them; otherwise only the redrawn columns need them again.
+    if (floorCast) {
+        PROFILE_SCOPE(Sprites);
+        workerPool.parallelFor(0, screenWidth, columnTileSize, [&](int begin, int end) {
+            shadeSprites(begin, end, state, map);
+        });
+    } else {
+        PROFILE_SCOPE(Sprites);
+        workerPool.parallelFor(0, static_cast<int>(dirtyColumns.size()), columnTileSize, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                shadeSprites(dirtyColumns[i], dirtyColumns[i] + 1, state, map);
+            }
+        });
     }
     
     // Apply dash effect if player is dashing
-    if (player.getIsDashing()) {
+    if (state.dashing) {
+        PROFILE_SCOPE(DashPost);
+
         // Start a new dash if not already active
         if (!dashActive) {
             dashActive = true;
@@ -742,41 +921,101 @@ void RayCaster::castRays(const Player& player, const Map& map)
         int debugHeight = 10;
         
         // Draw progress bar background
-        for (int x = debugX; x < debugX + debugWidth; x++) {
-            for (int y = debugY; y < debugY + debugHeight; y++) {
-                frameBuffer.setPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)}, sf::Color(50, 50, 50));
-            }
-        }
+        frameBuffer.fillRect(debugX, debugY, debugWidth, debugHeight, packColor(sf::Color(50, 50, 50)));
         
-        // Draw progress bar fill
+        // Draw progress bar fill, colored by phase
         int fillWidth = static_cast<int>(dashProgress * debugWidth);
-        for (int x = debugX; x < debugX + fillWidth; x++) {
-            for (int y = debugY; y < debugY + debugHeight; y++) {
-                // Color based on phase
-                sf::Color phaseColor;
-                if (dashProgress < 0.2f) phaseColor = sf::Color::Red;
-                else if (dashProgress < 0.7f) phaseColor = sf::Color::Green;
-                else phaseColor = sf::Color::Blue;
-                
-                frameBuffer.setPixel({static_cast<unsigned int>(x), static_cast<unsigned int>(y)}, phaseColor);
-            }
-        }
+        sf::Color phaseColor;
+        if (dashProgress < 0.2f) phaseColor = sf::Color::Red;
+        else if (dashProgress < 0.7f) phaseColor = sf::Color::Green;
+        else phaseColor = sf::Color::Blue;
+        frameBuffer.fillRect(debugX, debugY, fillWidth, debugHeight, packColor(phaseColor));
     } else {
         // Reset dash status if player stops dashing
         dashActive = false;
         
         // Only draw sword when not dashing
+        PROFILE_SCOPE(Sword);
         swordRenderer.draw(frameBuffer, player);
     }
     
     // Update the dash effect timer regardless of dash state
-    dashEffectTimer += 0.016f; // Assuming approximately 60 FPS
+    dashEffectTimer += deltaTime;
+
+    // Stage timings of the frames before this one
+    if (profileOverlay) {
+        overlay.draw(frameBuffer, Profiler::instance().history());
+    }
+
+    // Dash and overlay frames change every pixel, so only plain frames can be reused
+    frameValid = !state.dashing && !profileOverlay &&
+                 static_cast<int>(state.columnHits.size()) == frameBuffer.getWidth();
+    shadedPosition = state.position;
+    shadedDirection = state.direction;
+    shadedPlane = state.plane;
+    shadedTraceRevision = state.mapRevision;
+    shadedReconstructed = state.reconstructed;
+    shadedMapRevision = map.getRevision();
+    shadedPalette = palette;
     
-    // Update the texture with our pixel data
-    frameTexture.update(frameBuffer);
+    // Update the texture with the rows that changed
+    if (frameTexture && hasFrameChanged()) {
+        PROFILE_SCOPE(Upload);
+        // Below the output size the frame fills only the texture's top-left corner
+        unsigned width = static_cast<unsigned>(frameBuffer.getWidth());
+        frameTexture->update(reinterpret_cast<const std::uint8_t*>(frameBuffer.row(dirtyRowBegin)),
+                             sf::Vector2u(width, static_cast<unsigned>(dirtyRowEnd - dirtyRowBegin)),
+                             sf::Vector2u(0, static_cast<unsigned>(dirtyRowBegin)));
+    }
+}
+
+void RayCaster::setRenderResolution(int width, int height)
+{
+    width = std::clamp(width, 1, outputSize.x);
+    height = std::clamp(height, 1, outputSize.y);
+    if (width == frameBuffer.getWidth() && height == frameBuffer.getHeight()) return;
+
+    frameBuffer.resize(width, height);
+    if (columnMajor) {
+        columnBuffer.resize(height, width);
+    }
+    camera.setResolution(width, height);
+    frameValid = false;
+
+    // Show the top-left corner of the texture the frame is uploaded into,
+    // stretched over the whole output
+    if (frameSprite) {
+        frameSprite->setTextureRect(sf::IntRect({0, 0}, {width, height}));
+        frameSprite->setScale({static_cast<float>(outputSize.x) / width,
+                               static_cast<float>(outputSize.y) / height});
+    }
+}
+
+void RayCaster::setColumnMajor(bool enabled)
+{
+    columnMajor = enabled;
+    frameValid = false;
+
+    // Transposed: one row per screen column
+    if (columnMajor) {
+        columnBuffer.resize(frameBuffer.getHeight(), frameBuffer.getWidth());
+    } else {
+        columnBuffer.resize(0, 0);
+    }
+}
+
+void RayCaster::setPacketWidth(int width)
+{
+    // Only 1, 4 and 8 lane packets exist; never go wider than the CPU supports
+    int maxWidth = getMaxPacketWidth();
+    if (width >= 8 && maxWidth >= 8) packetWidth = 8;
+    else if (width >= 4 && maxWidth >= 4) packetWidth = 4;
+    else packetWidth = 1;
 }
 
 void RayCaster::draw(sf::RenderWindow& window)
 {
-    window.draw(frameSprite);
+    if (frameSprite) {
+        window.draw(*frameSprite);
+    }
 }
@@ -3,30 +3,30 @@
 #include "Player.hpp"
 #include "Map.hpp"
 #include <vector>
+#include <optional>
 #include "SwordRenderer.hpp"
-
-struct RayHit {
-    int mapX, mapY;      // Map coordinates where hit occurred
-    float distance;      // Perpendicular distance to the hit point
-    int side;            // Was it a NS or EW wall hit? (0 = x-side, 1 = y-side)
-    int wallType;        // Type of wall that was hit
-    bool isTarget;       // Is this a target?
-    bool isNewHit;       // Is this a new target hit?
-};
-
-struct TargetHit {
-    int x, y;            // Target coordinates
-    bool isNewHit;       // Is this a new hit or already registered?
-    int points;          // Points for this target
-};
+#include "ThreadPool.hpp"
+#include "FrameBuffer.hpp"
+#include "RayTraversal.hpp"
+#include "FrameState.hpp"
+#include "PostProcess.hpp"
+#include "ProfileOverlay.hpp"
+#include "WallTextureAtlas.hpp"
+#include "SpriteGrid.hpp"
+#include "Camera.hpp"
+#include "ColumnReconstructor.hpp"
 
 class RayCaster {
 private:
     // Existing members
-    sf::Image frameBuffer;
-    sf::Texture frameTexture;
-    sf::Sprite frameSprite;
+    FrameBuffer frameBuffer;                  // At the render resolution
+    FrameBuffer columnBuffer;                 // Transposed target: row x holds screen column x
+    std::optional<sf::Texture> frameTexture;  // Absent in headless mode
+    std::optional<sf::Sprite> frameSprite;    // Scales the render resolution up to the output size
+    sf::Vector2i outputSize;                  // Size the frame is presented at; the texture's size
     std::vector<sf::Color> wallColors;
+    WallTextureAtlas wallTextures;           // One texture per wall color, tinted by it
+    bool texturedWalls;
     std::vector<sf::Vector2f> previousPlayerPositions;
     SwordRenderer swordRenderer;
     
@@ -38,22 +38,84 @@ private:
     float dashDuration;          // How long the dash effect lasts
     bool dashActive;             // Is dash currently active
 
-    std::vector<TargetHit> hitTargets;
+    // Animation timers (per instance so several RayCasters can render side by side)
+    float pulseTimer;
+    float positionTrackTimer;
+    float lastPositionTime;
+
+    FrameState frameState;            // Scratch state for castRays
+    Camera camera;                    // Column tables for this resolution, pose of the last traceFrame
+    bool interlaced;                  // Trace alternate columns, estimate the rest
+    ColumnReconstructor reconstructor;
+    SpriteGrid spriteGrid;            // Map targets by block, for culling sprites to the view
+
+    // Column-parallel ray casting
+    ThreadPool workerPool;
+    static const int columnTileSize = 32;   // Columns per work-stealing tile
+    static const int transposeTileSize = 64; // Rows per transpose tile (multiple of the 8x8 block)
+    static const int floorTileSize = 16;     // Rows per floor and ceiling tile
+    bool columnMajor;                        // Render through columnBuffer
+    int packetWidth;                         // Rays traced together per DDA packet (1, 4 or 8)
+    bool profileOverlay;                     // Draw the stage timing graph over the frame
+    ProfileOverlay overlay;
+
+    // Colors that change at most once per frame (pulse, dash tint), shared by every column
+    struct ShadePalette {
+        std::vector<Pixel> walls;            // [min(wallType, wallColors.size()) * 2 + side]
+        Pixel activeTarget = 0;
+        Pixel hitTarget = 0;
+    };
+    ShadePalette palette;                    // For the frame being shaded
+
+    // Per column, the first row below its wall, and the same for the ceiling
+    // counted up from the bottom row; the floor pass fills from there
+    std::vector<int> floorStarts;
+    std::vector<int> ceilingStarts;
+
+    // Incremental rendering: while the view, the map and the dash state stay the
+    // same, frameBuffer is kept and only columns whose colors changed are redrawn
+    bool incremental;
+    bool frameValid;                         // frameBuffer holds a complete frame of the state below
+    sf::Vector2f shadedPosition;
+    sf::Vector2f shadedDirection;
+    sf::Vector2f shadedPlane;
+    std::uint64_t shadedTraceRevision;       // FrameState::mapRevision of the shaded hits
+    std::uint64_t shadedMapRevision;         // Map revision the target colors came from
+    bool shadedReconstructed;                // Shaded from interlaced estimates
+    ShadePalette shadedPalette;
+    std::vector<int> dirtyColumns;
+    std::vector<std::uint8_t> columnDirty;   // Scratch for collectDirtyColumns
+    int dirtyRowBegin, dirtyRowEnd;          // Rows changed by the last renderFrame
 
     
-    // Methods for slash effects
-    void applySimpleMotionBlur(float dirX, float dirY, float strength);
-    void drawMovingSlash(float dashProgress, int screenWidth, int screenHeight, const sf::Vector2f& playerDir, bool isHorizontal = false);
+    // Dash post-processing: passes run in row tiles on the worker pool
+    PostProcessor postProcessor;
+    DirectionalBlurPass dashBlur;
+    BorderGlowPass dashGlow;
+    SlashStrokePass slashStroke;
+    SplatPass dashSplats;            // Slash flash and trail, fade-out particles
+    RadialStamp flashStamp;          // Ring glow at the slash's leading edge
 
-    // Ray calculation
-    sf::Vector2f calculateRayDirection(int x, int screenWidth, const Player& player);
-    RayHit performRayCasting(const sf::Vector2f& rayDir, const sf::Vector2f& playerPos, const Map& map);
+    // Methods for slash effects
+    void queueMovingSlash(float dashProgress, int screenWidth, int screenHeight, const sf::Vector2f& playerDir, bool isHorizontal = false);
 
     // Rendering functions
     void clearFrameBuffer();
-    void renderWalls(int x, const RayHit& hit, int screenWidth, int screenHeight, const Player& player);
-    void renderTargets(int x, const RayHit& hit, int screenWidth, int screenHeight, const Map& map);
-    void renderFloorAndCeiling(const sf::Vector2f& playerPos);
+    ColumnSpan columnTarget(int x);
+    void traceColumns(int begin, int end, int step, const Map& map, HitBuffer& hits);
+    void traceParity(int parity, const Map& map, HitBuffer& hits);
+    void collectTargets(FrameState& state, const Map& map);
+    void shadeWalls(int begin, int end, int screenHeight, const HitBuffer& hits);
+    void shadeSprites(int begin, int end, const FrameState& state, const Map& map);
+    void buildPalette(bool dashing);
+    size_t wallSlot(const HitBuffer& hits, int x) const;
+    Pixel targetPixel(const Target& target) const;
+    bool canReuseFrame(const FrameState& state, const Map& map) const;
+    void collectDirtyColumns(const FrameState& state, const Map& map, int screenHeight);
+    void renderWalls(ColumnSpan column, const HitBuffer& hits, int x, int screenHeight);
+    void renderSprite(ColumnSpan column, const VisibleTarget& sprite, const Target& target, int x);
+    void collectWallExtents(const HitBuffer& hits, int screenWidth, int screenHeight);
+    void renderFloorAndCeiling(int rowBegin, int rowEnd, const FrameState& state);
     void applyDashEffect(float dashProgress, float dirX, float dirY);
     void updateDashEffects(const Player& player);
     void updateAfterimages(const sf::Vector2f& playerPos);
@@ -64,12 +126,67 @@ private:
     
 public:
     // Your existing public methods
-    RayCaster(int screenWidth, int screenHeight);
-    void castRays(const Player& player, const Map& map);
+    // Headless mode renders into the CPU framebuffer only (no GPU texture)
+    RayCaster(int screenWidth, int screenHeight, bool headless = false);
+
+    // Visibility pass: trace every column and find visible and hit targets. No pixels.
+    void traceFrame(const Player& player, const Map& map, FrameState& state);
+    // Shading pass: draw a traced frame, post effects and weapon into the framebuffer.
+    // deltaTime (real seconds since the last frame) drives the pulse and dash animations.
+    void renderFrame(const FrameState& state, const Player& player, const Map& map, float deltaTime = 0.016f);
+    // Both passes in one call
+    void castRays(const Player& player, const Map& map, float deltaTime = 0.016f);
     void draw(sf::RenderWindow& window);
 
-    const std::vector<TargetHit>& getHitTargets() const { return hitTargets; }
-    void clearHitTargets() { hitTargets.clear(); }
+    bool isHeadless() const { return !frameTexture.has_value(); }
+    const FrameBuffer& getFrameBuffer() const { return frameBuffer; }
+
+    // Render at a lower resolution and scale the frame up to the output size
+    // (the constructor's) when drawn. Clamped to [1, output size]. Buffers and
+    // the texture keep their allocations, so changing it between frames is cheap.
+    void setRenderResolution(int width, int height);
+    int getRenderWidth() const { return frameBuffer.getWidth(); }
+    int getRenderHeight() const { return frameBuffer.getHeight(); }
+    sf::Vector2i getOutputSize() const { return outputSize; }
+
+    // Worker threads used by castRays (including the caller); 0 = all hardware threads
+    void setThreadCount(unsigned threadCount) { workerPool.setThreadCount(threadCount); }
+    unsigned getThreadCount() const { return workerPool.getThreadCount(); }
+
+    // Render columns into a column-major buffer and transpose it into the frame
+    void setColumnMajor(bool enabled);
+    bool isColumnMajor() const { return columnMajor; }
+
+    // Rays per SIMD DDA packet: 1 (scalar), 4 or 8; clamped to what the CPU supports
+    void setPacketWidth(int width);
+    int getPacketWidth() const { return packetWidth; }
+
+    // Trace only every other column, alternating each frame, and rebuild the
+    // rest from the previous frame's hits moved into the new view. Halves the
+    // DDA work. Frames are estimates while the camera moves and exact again
+    // one frame after it stops.
+    void setInterlaced(bool enabled) { interlaced = enabled; }
+    bool isInterlaced() const { return interlaced; }
+
+    // Sample the wall textures (default) or fill walls with their flat color
+    void setTexturedWalls(bool enabled) { texturedWalls = enabled; frameValid = false; }
+    bool hasTexturedWalls() const { return texturedWalls; }
+
+    // Redraw only what changed while the view and map are unchanged (default on).
+    // Output is identical either way.
+    void setIncremental(bool enabled) { incremental = enabled; frameValid = false; }
+    bool isIncremental() const { return incremental; }
+    // Force the next frame to be drawn and uploaded in full
+    void invalidate() { frameValid = false; }
+    // Did the last renderFrame change any pixel? If not, the texture wasn't touched.
+    bool hasFrameChanged() const { return dirtyRowBegin < dirtyRowEnd; }
+
+    // Frame time graph from the profiler (empty unless built with RAYCASTER_PROFILING)
+    void setProfileOverlay(bool enabled) { profileOverlay = enabled; }
+    bool isProfileOverlayEnabled() const { return profileOverlay; }
+
+    const FrameState& getFrameState() const { return frameState; }
+    const Camera& getCamera() const { return camera; }
     
     // Add method to start a dash effect
     void startDash() {
@@ -0,0 +1,398 @@
+// RayTraversal.cpp
+#include "RayTraversal.hpp"
+#include <cmath>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define RAY_PACKET_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct RaySetup {
+    float deltaX, deltaY;    // Length of ray from one x or y-side to the next
+    float sideX, sideY;      // Length of ray from the origin to the first x or y-side
+    int stepX, stepY;        // Direction to step in x or y (either +1 or -1)
+};
+
+inline RaySetup setupRay(const sf::Vector2f& origin, const sf::Vector2f& rayDir, int mapX, int mapY)
+{
+    RaySetup ray;
+    ray.deltaX = std::abs(1 / rayDir.x);
+    ray.deltaY = std::abs(1 / rayDir.y);
+
+    if (rayDir.x < 0)
+    {
+        ray.stepX = -1;
+        ray.sideX = (origin.x - mapX) * ray.deltaX;
+    }
+    else
+    {
+        ray.stepX = 1;
+        ray.sideX = (mapX + 1.0f - origin.x) * ray.deltaX;
+    }
+
+    if (rayDir.y < 0)
+    {
+        ray.stepY = -1;
+        ray.sideY = (origin.y - mapY) * ray.deltaY;
+    }
+    else
+    {
+        ray.stepY = 1;
+        ray.sideY = (mapY + 1.0f - origin.y) * ray.deltaY;
+    }
+    return ray;
+}
+
+// Distance projected on camera direction to the entered side of a cell
+inline float perpendicularDistance(const sf::Vector2f& origin, const sf::Vector2f& rayDir,
+    int mapX, int mapY, int stepX, int stepY, int side)
+{
+    if (side == 0)
+    {
+        return (mapX - origin.x + (1 - stepX) / 2) / rayDir.x;
+    }
+    return (mapY - origin.y + (1 - stepY) / 2) / rayDir.y;
+}
+
+// Test the cell a ray just stepped into; returns true once the ray hit a wall
+inline bool visitCell(const Map& map, const sf::Vector2f& origin, const sf::Vector2f& rayDir,
+    int mapX, int mapY, int stepX, int stepY, int side, RayHit& hit)
+{
+    // Only the wall byte is read; targets are sprites (SpriteGrid) and don't
+    // stop rays. No bounds test: the map's solid padding stops every ray
+    // before it can leave.
+    int wallType = map.getWallTypeUnchecked(mapX, mapY);
+
+    if (wallType > 0) {
+        hit.mapX = mapX;
+        hit.mapY = mapY;
+        hit.side = side;
+        hit.wallType = wallType;
+        hit.distance = perpendicularDistance(origin, rayDir, mapX, mapY, stepX, stepY, side);
+        return true;
+    }
+    return false;
+}
+
+// Empty-space skipping. Inside an empty block (Map::getEmptyBlockShift) no
+// cell can stop a ray, so the march keeps stepping exactly
+// as before but stops looking at cells until it leaves the block. The float
+// side distances advance one step at a time either way, so the cells
+// visited, and every hit, stay identical to the plain DDA.
+inline int emptyBlockShiftAt(const std::uint8_t* shifts, int shiftStride, int mapX, int mapY)
+{
+    return shifts[((mapY + Map::PADDING) >> Map::emptyBlockShiftMin) * shiftStride +
+                  ((mapX + Map::PADDING) >> Map::emptyBlockShiftMin)];
+}
+
+// Steps along one axis before a ray at map coordinate mapCoord leaves its
+// empty block of 1 << shift cells
+inline int stepsToLeaveBlock(int mapCoord, int shift, int step)
+{
+    int inBlock = (mapCoord + Map::PADDING) & ((1 << shift) - 1);
+    return step > 0 ? (1 << shift) - inBlock : inBlock + 1;
+}
+
+#if RAY_PACKET_X86
+bool cpuHasAVX2()
+{
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+}
+
+__attribute__((target("avx2")))
+void traceRayPacket8AVX2(const sf::Vector2f& origin, const sf::Vector2f* rayDirs, const Map& map, RayHit* hits)
+{
+    int originX = static_cast<int>(origin.x);
+    int originY = static_cast<int>(origin.y);
+
+    alignas(32) float sideX[8], sideY[8], deltaX[8], deltaY[8];
+    alignas(32) int stepX[8], stepY[8], cellX[8], cellY[8], sides[8];
+
+    for (int lane = 0; lane < 8; lane++) {
+        RaySetup ray = setupRay(origin, rayDirs[lane], originX, originY);
+        sideX[lane] = ray.sideX;
+        sideY[lane] = ray.sideY;
+        deltaX[lane] = ray.deltaX;
+        deltaY[lane] = ray.deltaY;
+        stepX[lane] = ray.stepX;
+        stepY[lane] = ray.stepY;
+        hits[lane] = RayHit{};
+    }
+
+    __m256 sx = _mm256_load_ps(sideX);
+    __m256 sy = _mm256_load_ps(sideY);
+    const __m256 dx = _mm256_load_ps(deltaX);
+    const __m256 dy = _mm256_load_ps(deltaY);
+    __m256i mx = _mm256_set1_epi32(originX);
+    __m256i my = _mm256_set1_epi32(originY);
+    const __m256i stX = _mm256_load_si256(reinterpret_cast<const __m256i*>(stepX));
+    const __m256i stY = _mm256_load_si256(reinterpret_cast<const __m256i*>(stepY));
+    const __m256i one = _mm256_set1_epi32(1);
+
+    const std::uint8_t* cells = map.getCellData();
+    const __m256i stride = _mm256_set1_epi32(map.getStride());
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+    // Empty-space skipping: steps each lane has left in x and y before it
+    // leaves the empty block it is crossing; a lane is inside while both are > 0
+    const std::uint8_t* emptyShifts = map.getEmptyBlockShiftData();
+    const __m256i emptyStride = _mm256_set1_epi32(map.getEmptyBlockStride());
+    const __m256i padding = _mm256_set1_epi32(Map::PADDING);
+    const __m256i positiveX = _mm256_cmpgt_epi32(stX, _mm256_setzero_si256());
+    const __m256i positiveY = _mm256_cmpgt_epi32(stY, _mm256_setzero_si256());
+    __m256i blockStepsX = _mm256_setzero_si256();
+    __m256i blockStepsY = _mm256_setzero_si256();
+
+    int active = 0xFF;
+    while (active) {
+        // Masked step: each lane advances along x or y, exactly like the scalar DDA
+        __m256 xStep = _mm256_cmp_ps(sx, sy, _CMP_LT_OQ);
+        __m256i xMask = _mm256_castps_si256(xStep);
+        sx = _mm256_add_ps(sx, _mm256_and_ps(xStep, dx));
+        sy = _mm256_add_ps(sy, _mm256_andnot_ps(xStep, dy));
+        mx = _mm256_add_epi32(mx, _mm256_and_si256(xMask, stX));
+        my = _mm256_add_epi32(my, _mm256_andnot_si256(xMask, stY));
+
+        // Lanes still inside their empty block need no lookup at all
+        blockStepsX = _mm256_add_epi32(blockStepsX, xMask);
+        blockStepsY = _mm256_add_epi32(blockStepsY, _mm256_andnot_si256(xMask, _mm256_set1_epi32(-1)));
+        __m256i inside = _mm256_and_si256(_mm256_cmpgt_epi32(blockStepsX, _mm256_setzero_si256()),
+                                          _mm256_cmpgt_epi32(blockStepsY, _mm256_setzero_si256()));
+        int lookup = active & ~_mm256_movemask_ps(_mm256_castsi256_ps(inside));
+        if (!lookup) continue;
+
+        // Lanes that stepped into an empty block start crossing it
+        __m256i live = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(lookup), laneBits), laneBits);
+        __m256i px = _mm256_add_epi32(mx, padding);
+        __m256i py = _mm256_add_epi32(my, padding);
+        __m256i shiftIndex = _mm256_add_epi32(
+            _mm256_mullo_epi32(_mm256_srli_epi32(py, Map::emptyBlockShiftMin), emptyStride),
+            _mm256_srli_epi32(px, Map::emptyBlockShiftMin));
+        __m256i shifts = _mm256_and_si256(_mm256_mask_i32gather_epi32(
+            _mm256_setzero_si256(), reinterpret_cast<const int*>(emptyShifts), shiftIndex, live, 1), byteMask);
+        __m256i entering = _mm256_andnot_si256(_mm256_cmpeq_epi32(shifts, _mm256_setzero_si256()), live);
+        if (!_mm256_testz_si256(entering, entering)) {
+            __m256i blockMask = _mm256_sub_epi32(_mm256_sllv_epi32(one, shifts), one);
+            __m256i inX = _mm256_and_si256(px, blockMask);
+            __m256i inY = _mm256_and_si256(py, blockMask);
+            __m256i blockSize = _mm256_add_epi32(blockMask, one);
+            __m256i stepsX = _mm256_blendv_epi8(_mm256_add_epi32(inX, one), _mm256_sub_epi32(blockSize, inX), positiveX);
+            __m256i stepsY = _mm256_blendv_epi8(_mm256_add_epi32(inY, one), _mm256_sub_epi32(blockSize, inY), positiveY);
+            blockStepsX = _mm256_blendv_epi8(blockStepsX, stepsX, entering);
+            blockStepsY = _mm256_blendv_epi8(blockStepsY, stepsY, entering);
+            live = _mm256_andnot_si256(entering, live);
+            lookup &= ~_mm256_movemask_ps(_mm256_castsi256_ps(entering));
+            if (!lookup) continue;
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(cellX), mx);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(cellY), my);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sides), _mm256_andnot_si256(xMask, one));
+
+        // Gather the wall byte of every live lane's cell. Most cells are
+        // empty, so only lanes that hit a wall go scalar.
+        // Retired lanes keep stepping past the padding and must not load.
+        __m256i offsets = _mm256_add_epi32(_mm256_mullo_epi32(my, stride), mx);
+        __m256i walls = _mm256_and_si256(_mm256_mask_i32gather_epi32(
+            _mm256_setzero_si256(), reinterpret_cast<const int*>(cells), offsets, live, 1), byteMask);
+        __m256i empty = _mm256_cmpeq_epi32(walls, _mm256_setzero_si256());
+        int interesting = lookup & ~_mm256_movemask_ps(_mm256_castsi256_ps(empty));
+        if (!interesting) continue;
+
+        // Lanes retire as they hit walls
+        for (int lane = 0; lane < 8; lane++) {
+            if (!(interesting & (1 << lane))) continue;
+            if (visitCell(map, origin, rayDirs[lane], cellX[lane], cellY[lane],
+                          stepX[lane], stepY[lane], sides[lane], hits[lane])) {
+                active &= ~(1 << lane);
+            }
+        }
+    }
+}
+#endif // RAY_PACKET_X86
+
+} // namespace
+
+RayHit traceRay(const sf::Vector2f& origin, const sf::Vector2f& rayDir, const Map& map)
+{
+    RayHit hit{};
+
+    // Which box of the map we're in
+    int mapX = static_cast<int>(origin.x);
+    int mapY = static_cast<int>(origin.y);
+    RaySetup ray = setupRay(origin, rayDir, mapX, mapY);
+
+    const std::uint8_t* emptyShifts = map.getEmptyBlockShiftData();
+    const int emptyStride = map.getEmptyBlockStride();
+
+    while (true)
+    {
+        // Jump to next map square, either in x-direction, or in y-direction
+        int side;
+        if (ray.sideX < ray.sideY)
+        {
+            ray.sideX += ray.deltaX;
+            mapX += ray.stepX;
+            side = 0;
+        }
+        else
+        {
+            ray.sideY += ray.deltaY;
+            mapY += ray.stepY;
+            side = 1;
+        }
+
+        // Cross empty blocks without looking at their cells
+        int shift;
+        while ((shift = emptyBlockShiftAt(emptyShifts, emptyStride, mapX, mapY)) != 0)
+        {
+            // Branch-free: the x/y choice is a coin flip the predictor can't
+            // learn. Adding 0 leaves a side distance exactly as it was.
+            int stepsX = stepsToLeaveBlock(mapX, shift, ray.stepX);
+            int stepsY = stepsToLeaveBlock(mapY, shift, ray.stepY);
+            do
+            {
+                bool xStep = ray.sideX < ray.sideY;
+                ray.sideX += xStep ? ray.deltaX : 0.0f;
+                ray.sideY += xStep ? 0.0f : ray.deltaY;
+                mapX += xStep ? ray.stepX : 0;
+                mapY += xStep ? 0 : ray.stepY;
+                stepsX -= xStep;
+                stepsY -= !xStep;
+                side = !xStep;
+            } while (stepsX != 0 && stepsY != 0);
+        }
+
+        if (visitCell(map, origin, rayDir, mapX, mapY, ray.stepX, ray.stepY, side, hit)) {
+            return hit;
+        }
+    }
+}
+
+void traceRayPacket4(const sf::Vector2f& origin, const sf::Vector2f* rayDirs, const Map& map, RayHit* hits)
+{
+#if RAY_PACKET_X86
+    int originX = static_cast<int>(origin.x);
+    int originY = static_cast<int>(origin.y);
+
+    alignas(16) float sideX[4], sideY[4], deltaX[4], deltaY[4];
+    alignas(16) int stepX[4], stepY[4], cellX[4], cellY[4], sides[4], blockX[4], blockY[4];
+
+    for (int lane = 0; lane < 4; lane++) {
+        RaySetup ray = setupRay(origin, rayDirs[lane], originX, originY);
+        sideX[lane] = ray.sideX;
+        sideY[lane] = ray.sideY;
+        deltaX[lane] = ray.deltaX;
+        deltaY[lane] = ray.deltaY;
+        stepX[lane] = ray.stepX;
+        stepY[lane] = ray.stepY;
+        hits[lane] = RayHit{};
+    }
+
+    __m128 sx = _mm_load_ps(sideX);
+    __m128 sy = _mm_load_ps(sideY);
+    const __m128 dx = _mm_load_ps(deltaX);
+    const __m128 dy = _mm_load_ps(deltaY);
+    __m128i mx = _mm_set1_epi32(originX);
+    __m128i my = _mm_set1_epi32(originY);
+    const __m128i stX = _mm_load_si128(reinterpret_cast<const __m128i*>(stepX));
+    const __m128i stY = _mm_load_si128(reinterpret_cast<const __m128i*>(stepY));
+    const __m128i one = _mm_set1_epi32(1);
+
+    const std::uint8_t* cells = map.getCellData();
+    const int stride = map.getStride();
+
+    // Empty-space skipping: steps each lane has left in x and y before it
+    // leaves the empty block it is crossing; a lane is inside while both are > 0
+    const std::uint8_t* emptyShifts = map.getEmptyBlockShiftData();
+    const int emptyStride = map.getEmptyBlockStride();
+    __m128i blockStepsX = _mm_setzero_si128();
+    __m128i blockStepsY = _mm_setzero_si128();
+
+    int active = 0xF;
+    while (active) {
+        // Masked step: each lane advances along x or y, exactly like the scalar DDA.
+        // Lanes that don't step add +0, which leaves their side distance unchanged.
+        __m128 xStep = _mm_cmplt_ps(sx, sy);
+        __m128i xMask = _mm_castps_si128(xStep);
+        sx = _mm_add_ps(sx, _mm_and_ps(xStep, dx));
+        sy = _mm_add_ps(sy, _mm_andnot_ps(xStep, dy));
+        mx = _mm_add_epi32(mx, _mm_and_si128(xMask, stX));
+        my = _mm_add_epi32(my, _mm_andnot_si128(xMask, stY));
+
+        // Lanes still inside their empty block need no lookup at all
+        blockStepsX = _mm_add_epi32(blockStepsX, xMask);
+        blockStepsY = _mm_add_epi32(blockStepsY, _mm_andnot_si128(xMask, _mm_set1_epi32(-1)));
+        __m128i inside = _mm_and_si128(_mm_cmpgt_epi32(blockStepsX, _mm_setzero_si128()),
+                                       _mm_cmpgt_epi32(blockStepsY, _mm_setzero_si128()));
+        int lookup = active & ~_mm_movemask_ps(_mm_castsi128_ps(inside));
+        if (!lookup) continue;
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(cellX), mx);
+        _mm_store_si128(reinterpret_cast<__m128i*>(cellY), my);
+        _mm_store_si128(reinterpret_cast<__m128i*>(sides), _mm_andnot_si128(xMask, one));
+
+        // Fetch the cells of all live lanes; lanes retire as they hit walls.
+        // Lanes that stepped into an empty block start crossing it, and
+        // other empty cells are skipped straight from the raw padded storage.
+        bool entered = false;
+        for (int lane = 0; lane < 4; lane++) {
+            if (!(lookup & (1 << lane))) continue;
+            int shift = emptyBlockShiftAt(emptyShifts, emptyStride, cellX[lane], cellY[lane]);
+            if (shift) {
+                if (!entered) {
+                    _mm_store_si128(reinterpret_cast<__m128i*>(blockX), blockStepsX);
+                    _mm_store_si128(reinterpret_cast<__m128i*>(blockY), blockStepsY);
+                    entered = true;
+                }
+                blockX[lane] = stepsToLeaveBlock(cellX[lane], shift, stepX[lane]);
+                blockY[lane] = stepsToLeaveBlock(cellY[lane], shift, stepY[lane]);
+                continue;
+            }
+            int offset = cellY[lane] * stride + cellX[lane];
+            if (cells[offset] == 0) continue;
+            if (visitCell(map, origin, rayDirs[lane], cellX[lane], cellY[lane],
+                          stepX[lane], stepY[lane], sides[lane], hits[lane])) {
+                active &= ~(1 << lane);
+            }
+        }
+        if (entered) {
+            blockStepsX = _mm_load_si128(reinterpret_cast<const __m128i*>(blockX));
+            blockStepsY = _mm_load_si128(reinterpret_cast<const __m128i*>(blockY));
+        }
+    }
+#else
+    for (int lane = 0; lane < 4; lane++) {
+        hits[lane] = traceRay(origin, rayDirs[lane], map);
+    }
+#endif
+}
+
+void traceRayPacket8(const sf::Vector2f& origin, const sf::Vector2f* rayDirs, const Map& map, RayHit* hits)
+{
+#if RAY_PACKET_X86
+    if (cpuHasAVX2()) {
+        traceRayPacket8AVX2(origin, rayDirs, map, hits);
+        return;
+    }
+#endif
+    traceRayPacket4(origin, rayDirs, map, hits);
+    traceRayPacket4(origin, rayDirs + 4, map, hits + 4);
+}
+
+int getMaxPacketWidth()
+{
+#if RAY_PACKET_X86
+    return cpuHasAVX2() ? 8 : 4;
+#else
+    return 1;
+#endif
+}
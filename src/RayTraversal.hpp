@@ -0,0 +1,23 @@
+// RayTraversal.hpp
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include "Map.hpp"
+
+struct RayHit {
+    int mapX, mapY;      // Map coordinates where hit occurred
+    float distance;      // Perpendicular distance to the hit point
+    int side;            // Was it a NS or EW wall hit? (0 = x-side, 1 = y-side)
+    int wallType;        // Type of wall that was hit
+};
+
+// Scalar DDA: march one ray from origin until it enters a wall cell.
+// origin must lie inside the map; the map's solid padding bounds every ray.
+RayHit traceRay(const sf::Vector2f& origin, const sf::Vector2f& rayDir, const Map& map);
+
+// Packet DDA: march 4 or 8 rays from the same origin together in SIMD lanes.
+// Lanes retire independently as they hit walls; every hit is identical to traceRay.
+void traceRayPacket4(const sf::Vector2f& origin, const sf::Vector2f* rayDirs, const Map& map, RayHit* hits);
+void traceRayPacket8(const sf::Vector2f& origin, const sf::Vector2f* rayDirs, const Map& map, RayHit* hits);
+
+// Widest packet the CPU supports: 8 (AVX2), 4 (SSE2) or 1 (scalar only)
+int getMaxPacketWidth();
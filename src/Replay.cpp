@@ -0,0 +1,252 @@
+// Replay.cpp
+#include "Replay.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+ReplayRecorder::~ReplayRecorder()
+{
+    if (file.is_open()) flushRun();
+}
+
+bool ReplayRecorder::open(const std::string& filename, const ReplayHeader& startHeader)
+{
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Error: Could not open replay file for writing " << filename << std::endl;
+        return false;
+    }
+    path = filename;
+
+    ReplayHeader header = startHeader;
+    std::memcpy(header.magic, replayMagic, sizeof(replayMagic));
+    header.version = replayVersion;
+    header.headerSize = sizeof(ReplayHeader);
+    header.checkpointInterval = std::max<std::uint32_t>(header.checkpointInterval, 1);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    interval = header.checkpointInterval;
+    steps = 0;
+    runLength = 0;
+    return true;
+}
+
+void ReplayRecorder::record(const InputState& input)
+{
+    if (!file.is_open()) return;
+    if (runLength > 0 && input.buttons != runInput.buttons) flushRun();
+    runInput = input;
+    runLength++;
+    steps++;
+}
+
+void ReplayRecorder::checkpoint(std::uint64_t stateHash)
+{
+    if (!file.is_open()) return;
+    flushRun();
+    file.put(static_cast<char>(replayRecordCheckpoint));
+    writeVarint(steps);
+    writeHash(stateHash);
+}
+
+bool ReplayRecorder::close(std::uint64_t finalHash)
+{
+    if (!file.is_open()) return false;
+    flushRun();
+    file.put(static_cast<char>(replayRecordEnd));
+    writeVarint(steps);
+    writeHash(finalHash);
+    file.close();
+
+    if (!file)
+    {
+        std::cerr << "Error: Failed writing replay file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ReplayRecorder::flushRun()
+{
+    if (runLength == 0) return;
+    file.put(static_cast<char>(replayRecordInput));
+    file.put(static_cast<char>(runInput.buttons));
+    writeVarint(runLength);
+    runLength = 0;
+}
+
+void ReplayRecorder::writeVarint(std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        file.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    file.put(static_cast<char>(value));
+}
+
+void ReplayRecorder::writeHash(std::uint64_t hash)
+{
+    char bytes[sizeof(hash)];
+    std::memcpy(bytes, &hash, sizeof(hash));
+    file.write(bytes, sizeof(bytes));
+}
+
+bool ReplayInput::open(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Error: Could not open replay file " << filename << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    path = filename;
+
+    if (data.size() < sizeof(header) || std::memcmp(data.data(), replayMagic, sizeof(replayMagic)) != 0)
+    {
+        std::cerr << "Error: " << filename << " is not a replay file or is truncated" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.version != replayVersion)
+    {
+        std::cerr << "Error: Replay file " << filename << " has unsupported version " << header.version << std::endl;
+        return false;
+    }
+    if (header.headerSize < sizeof(header) || header.headerSize > data.size() ||
+        header.checkpointInterval == 0 || !(header.stepSeconds > 0.0f))
+    {
+        std::cerr << "Error: Replay file " << filename << " has an invalid header" << std::endl;
+        return false;
+    }
+
+    std::size_t offset = header.headerSize;
+    auto readVarint = [&](std::uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && offset < data.size(); shift += 7)
+        {
+            unsigned char byte = data[offset++];
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    };
+    auto readHash = [&](std::uint64_t& hash) {
+        if (data.size() - offset < sizeof(hash)) return false;
+        std::memcpy(&hash, data.data() + offset, sizeof(hash));
+        offset += sizeof(hash);
+        return true;
+    };
+
+    runs.clear();
+    checkpoints.clear();
+    stepCount = 0;
+    bool ended = false;
+    while (offset < data.size() && !ended)
+    {
+        // Records are read whole or not at all, so a cut-off log keeps
+        // every step before the cut
+        std::size_t recordStart = offset;
+        std::uint8_t tag = data[offset++];
+        bool complete = false;
+        if (tag == replayRecordInput)
+        {
+            Run run;
+            if (offset < data.size())
+            {
+                run.input.buttons = data[offset++];
+                complete = readVarint(run.length) && run.length > 0;
+            }
+            if (complete)
+            {
+                runs.push_back(run);
+                stepCount += run.length;
+            }
+        }
+        else if (tag == replayRecordCheckpoint || tag == replayRecordEnd)
+        {
+            Checkpoint checkpoint;
+            complete = readVarint(checkpoint.step) && readHash(checkpoint.hash);
+            if (complete && checkpoint.step != stepCount)
+            {
+                std::cerr << "Error: Replay file " << filename << " has a checkpoint at step " << checkpoint.step
+                          << " after " << stepCount << " steps of input" << std::endl;
+                return false;
+            }
+            if (complete)
+            {
+                checkpoints.push_back(checkpoint);
+                ended = tag == replayRecordEnd;
+            }
+        }
+        else
+        {
+            std::cerr << "Error: Replay file " << filename << " has an unknown record at byte " << recordStart << std::endl;
+            return false;
+        }
+
+        if (!complete)
+        {
+            offset = recordStart;
+            break;
+        }
+    }
+
+    if (!ended)
+    {
+        std::cerr << "Warning: Replay file " << filename << " has no end record; playing its "
+                  << stepCount << " complete steps" << std::endl;
+    }
+    rewind();
+    return true;
+}
+
+bool ReplayInput::next(InputState& input)
+{
+    if (runIndex >= runs.size())
+    {
+        input = InputState();
+        return false;
+    }
+
+    input = runs[runIndex].input;
+    played++;
+    if (++runOffset == runs[runIndex].length)
+    {
+        runIndex++;
+        runOffset = 0;
+    }
+    return true;
+}
+
+void ReplayInput::rewind()
+{
+    runIndex = 0;
+    runOffset = 0;
+    played = 0;
+}
+
+const ReplayInput::Checkpoint* ReplayInput::findCheckpoint(std::uint64_t step) const
+{
+    auto it = std::lower_bound(checkpoints.begin(), checkpoints.end(), step,
+        [](const Checkpoint& checkpoint, std::uint64_t value) { return checkpoint.step < value; });
+    return it != checkpoints.end() && it->step == step ? &*it : nullptr;
+}
+
+bool ReplayInput::hasCheckpoint(std::uint64_t step) const
+{
+    return findCheckpoint(step) != nullptr;
+}
+
+bool ReplayInput::verify(std::uint64_t step, std::uint64_t stateHash) const
+{
+    const Checkpoint* checkpoint = findCheckpoint(step);
+    if (!checkpoint || checkpoint->hash == stateHash) return true;
+
+    std::cerr << "Replay " << path << " diverged at step " << step << ": state hash " << std::hex
+              << stateHash << ", recorded " << checkpoint->hash << std::dec << std::endl;
+    return false;
+}
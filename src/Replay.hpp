@@ -0,0 +1,122 @@
+// Replay.hpp
+#pragma once
+#include "Input.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Replay log (.rcreplay): the input of every simulation step of a session,
+// with state hashes to check a playback against. All numbers little-endian.
+//
+//   ReplayHeader
+//   records, each a tag byte and its fields:
+//     replayRecordInput       buttons (1 byte), step count (varint): a run
+//                             of steps with the same input
+//     replayRecordCheckpoint  step (varint), state hash (8 bytes): the
+//                             hashSimulationState after that many steps
+//     replayRecordEnd         step count (varint), final state hash (8 bytes)
+//
+// Varints are LEB128. A checkpoint follows every checkpointInterval steps
+// and ends the run before it, so a reader meets each checkpoint exactly
+// when its step is reached. A log cut off before its end record (the game
+// was killed) still plays up to the last complete record.
+
+const char replayMagic[4] = {'R', 'C', 'R', 'P'};
+const std::uint32_t replayVersion = 1;
+
+const std::uint8_t replayRecordInput = 1;
+const std::uint8_t replayRecordCheckpoint = 2;
+const std::uint8_t replayRecordEnd = 3;
+
+struct ReplayHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t headerSize;           // sizeof(ReplayHeader) when written
+    std::uint32_t checkpointInterval;   // Steps between checkpoints
+    float stepSeconds;                  // Length of one simulation step
+    float startPosition[2];             // Player pose before the first step
+    float startDirection[2];
+    float startPlane[2];
+    std::uint32_t reserved;
+    std::uint64_t mapHash;              // hashMapLayout of the starting map
+    std::uint64_t startHash;            // hashSimulationState before the first step
+};
+
+static_assert(sizeof(ReplayHeader) == 64, "ReplayHeader layout is part of the file format");
+
+// Writes a replay log as a session runs
+class ReplayRecorder {
+public:
+    // Without close the log is left cut off after its last step
+    ~ReplayRecorder();
+
+    // header: everything but magic, version and size. Prints why on failure.
+    bool open(const std::string& path, const ReplayHeader& header);
+    bool isOpen() const { return file.is_open(); }
+
+    // After each step, its input. When isCheckpointDue, follow with checkpoint.
+    void record(const InputState& input);
+    bool isCheckpointDue() const { return steps % interval == 0; }
+    void checkpoint(std::uint64_t stateHash);
+
+    // Write the end record and close. False if any write failed.
+    bool close(std::uint64_t finalHash);
+
+    std::uint64_t getStepCount() const { return steps; }
+
+private:
+    std::ofstream file;
+    std::string path;
+    std::uint32_t interval = 1;
+    std::uint64_t steps = 0;
+    InputState runInput;                // Run being collected
+    std::uint64_t runLength = 0;
+
+    void flushRun();
+    void writeVarint(std::uint64_t value);
+    void writeHash(std::uint64_t hash);
+};
+
+// Plays a replay log back as a step input source, and checks the states
+// the steps reach against the recorded hashes
+class ReplayInput : public InputSource {
+public:
+    // Read and check the whole log. Prints why on failure.
+    bool open(const std::string& path);
+
+    bool next(InputState& input) override;
+    // Back to the first step, to play the log again
+    void rewind();
+
+    const ReplayHeader& getHeader() const { return header; }
+    std::uint64_t getStepCount() const { return stepCount; }
+    std::uint64_t getStepsPlayed() const { return played; }
+
+    // Is there a recorded hash for the state after this many steps?
+    bool hasCheckpoint(std::uint64_t step) const;
+    // Compare with the recorded hash; prints the divergence and returns false
+    // on a mismatch. Steps without a checkpoint pass.
+    bool verify(std::uint64_t step, std::uint64_t stateHash) const;
+
+private:
+    struct Run {
+        InputState input;
+        std::uint64_t length;
+    };
+    struct Checkpoint {
+        std::uint64_t step;
+        std::uint64_t hash;
+    };
+
+    std::string path;
+    ReplayHeader header = {};
+    std::vector<Run> runs;
+    std::vector<Checkpoint> checkpoints;   // By step; the end record is the last
+    std::uint64_t stepCount = 0;
+    std::size_t runIndex = 0;              // Playback position
+    std::uint64_t runOffset = 0;
+    std::uint64_t played = 0;
+
+    const Checkpoint* findCheckpoint(std::uint64_t step) const;
+};
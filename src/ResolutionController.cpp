@@ -0,0 +1,67 @@
+// ResolutionController.cpp
+#include "ResolutionController.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+ResolutionController::ResolutionController(const Settings& settings)
+    : settings(settings)
+{
+    this->settings.minScale = std::clamp(settings.minScale, settings.scaleQuantum, 1.0f);
+    this->settings.maxScale = std::clamp(settings.maxScale, this->settings.minScale, 1.0f);
+    this->settings.windowFrames = std::max(1, settings.windowFrames);
+    scale = this->settings.maxScale;
+    stats.scale = scale;
+}
+
+float ResolutionController::snapScale(float value) const
+{
+    value = std::round(value / settings.scaleQuantum) * settings.scaleQuantum;
+    return std::clamp(value, settings.minScale, settings.maxScale);
+}
+
+int ResolutionController::scaledSize(int outputSize) const
+{
+    return std::max(1, static_cast<int>(std::lround(outputSize * scale)));
+}
+
+bool ResolutionController::addFrame(float frameTime)
+{
+    stats.frames++;
+    if (frameTime > settings.targetFrameTime) stats.framesOverBudget++;
+
+    windowTotal += frameTime;
+    windowPeak = std::max(windowPeak, frameTime);
+    if (++windowCount < settings.windowFrames) return false;
+
+    float average = windowTotal / windowCount;
+    stats.averageFrameTime = average;
+    stats.peakFrameTime = windowPeak;
+    windowTotal = 0.0f;
+    windowPeak = 0.0f;
+    windowCount = 0;
+
+    // Inside the band, or an idle stretch that measured nothing: keep the scale
+    float load = average / settings.targetFrameTime;
+    if (average <= 0.0f || (load >= settings.lowerBand && load <= settings.upperBand)) return false;
+
+    // Cost goes with the square of the scale; aim for the middle of the band
+    float aim = 0.5f * (settings.lowerBand + settings.upperBand);
+    float wanted = scale * std::sqrt(aim / load);
+    float next = snapScale(std::min(wanted, scale + settings.maxScaleUp));
+    if (next == scale) return false;
+
+    if (next > scale) stats.scaleUps++; else stats.scaleDowns++;
+    scale = next;
+    stats.scale = scale;
+    return true;
+}
+
+std::string ResolutionController::getStatsText() const
+{
+    char text[64];
+    std::snprintf(text, sizeof(text), "RES %d%% %.1f MS (PEAK %.1f)",
+                  static_cast<int>(std::lround(scale * 100.0f)),
+                  stats.averageFrameTime * 1000.0f, stats.peakFrameTime * 1000.0f);
+    return text;
+}
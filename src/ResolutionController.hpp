@@ -0,0 +1,63 @@
+// ResolutionController.hpp
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Dynamic resolution: watches how long frames take to render and picks the
+// render scale (per axis, of the output resolution) that holds them at a
+// budget. Render cost grows with the pixel count, the square of the scale,
+// so a change aims for the middle of the tolerance band in one step.
+//
+// Hysteresis keeps it from hunting: decisions come once per window of
+// frames, nothing changes while the average stays inside the band, scales
+// snap to a coarse grid, and growing is capped per step while shrinking is
+// not, since a missed budget hurts more than a few lost pixels.
+class ResolutionController {
+public:
+    struct Settings {
+        float targetFrameTime = 1.0f / 60.0f;  // Seconds of render work per frame
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        float scaleQuantum = 1.0f / 16.0f;     // Scales snap to multiples of this
+        float maxScaleUp = 0.125f;             // Largest growth per decision
+        float upperBand = 1.0f;                // Shrink when the average is above target * upperBand
+        float lowerBand = 0.75f;               // Grow when it is below target * lowerBand
+        int windowFrames = 30;                 // Frames averaged per decision
+    };
+
+    struct Stats {
+        float scale = 1.0f;
+        float averageFrameTime = 0.0f;         // Of the last full window, seconds
+        float peakFrameTime = 0.0f;            // Slowest frame of that window
+        std::uint64_t frames = 0;
+        std::uint64_t framesOverBudget = 0;
+        std::uint32_t scaleUps = 0;
+        std::uint32_t scaleDowns = 0;
+    };
+
+    ResolutionController() : ResolutionController(Settings()) {}
+    explicit ResolutionController(const Settings& settings);
+
+    // Record one frame's render time in seconds. Returns true when the scale
+    // changed; apply it before rendering the next frame.
+    bool addFrame(float frameTime);
+
+    float getScale() const { return scale; }
+    // Output size times the scale, at least one pixel
+    int scaledSize(int outputSize) const;
+
+    const Settings& getSettings() const { return settings; }
+    const Stats& getStats() const { return stats; }
+    // One line for an on-screen readout, e.g. "RES 75% 12.4 MS (PEAK 15.0)"
+    std::string getStatsText() const;
+
+private:
+    Settings settings;
+    Stats stats;
+    float scale;
+    float windowTotal = 0.0f;              // Frame times of the window being collected
+    float windowPeak = 0.0f;
+    int windowCount = 0;
+
+    float snapScale(float value) const;
+};
@@ -0,0 +1,85 @@
+// Simulation.cpp
+#include "Simulation.hpp"
+#include "RayTraversal.hpp"
+#include "StateHash.hpp"
+#include <cmath>
+
+// Score the unhit targets a dashing player passes within reach of. A target
+// counts only if it's on screen and not behind a wall, the same view the
+// player sees it in, but tested geometrically so the result doesn't depend
+// on the render resolution or the frame rate.
+static int scoreDashHits(const Player& player, Map& map)
+{
+    if (!player.getIsDashing()) return 0;
+
+    const float hitRadius = 1.0f;
+    const float nearPlane = 0.1f;
+    const float targetRadius = 0.25f;   // Half the sprite width, as RayCaster draws it
+
+    sf::Vector2f pos = player.getPosition();
+    sf::Vector2f dir = player.getDirection();
+    sf::Vector2f plane = player.getPlane();
+    float det = plane.x * dir.y - dir.x * plane.y;
+    if (det == 0.0f) return 0;
+    float invDet = 1.0f / det;
+    float halfWidth = targetRadius / std::sqrt(plane.x * plane.x + plane.y * plane.y);
+
+    // Target centres within hitRadius lie in the 3x3 cells around the player
+    int points = 0;
+    int cellX = static_cast<int>(std::floor(pos.x));
+    int cellY = static_cast<int>(std::floor(pos.y));
+    for (int y = cellY - 1; y <= cellY + 1; y++) {
+        for (int x = cellX - 1; x <= cellX + 1; x++) {
+            if (!map.isTarget(x, y) || map.isHitTarget(x, y)) continue;
+
+            float dx = x + 0.5f - pos.x;
+            float dy = y + 0.5f - pos.y;
+            if (dx * dx + dy * dy >= hitRadius * hitRadius) continue;
+
+            // In front and at least partly inside the screen edges
+            float depth = invDet * (-plane.y * dx + plane.x * dy);
+            float cameraX = invDet * (dir.y * dx - dir.x * dy);
+            if (depth < nearPlane || cameraX - halfWidth >= depth || cameraX + halfWidth <= -depth) continue;
+
+            // The sight line reaches the centre before any wall
+            if (traceRay(pos, sf::Vector2f(dx, dy), map).distance < 1.0f) continue;
+
+            if (map.hitTarget(x, y)) {
+                points += map.getTargetPoints(x, y);
+            }
+        }
+    }
+    return points;
+}
+
+int stepSimulation(Player& player, Map& map, const InputState& input, float deltaTime)
+{
+    player.handleInput(deltaTime, input, map);
+    player.update(deltaTime);
+    return scoreDashHits(player, map);
+}
+
+std::uint64_t hashSimulationState(const Player& player, const Map& map, int score)
+{
+    StateHash hash(player.hashState(StateHash::offsetBasis));
+    hash.add(score);
+    for (const Target& target : map.getTargets()) {
+        hash.add(target.x).add(target.y).add(target.points).add(target.hit);
+    }
+    return hash.get();
+}
+
+std::uint64_t hashMapLayout(const Map& map)
+{
+    StateHash hash;
+    hash.add(map.getWidth()).add(map.getHeight());
+    for (int y = 0; y < map.getHeight(); y++) {
+        for (int x = 0; x < map.getWidth(); x++) {
+            hash.add(map.getValueAt(x, y));
+        }
+    }
+    for (const Target& target : map.getTargets()) {
+        hash.add(target.x).add(target.y).add(target.points).add(target.hit);
+    }
+    return hash.get();
+}
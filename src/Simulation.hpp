@@ -0,0 +1,20 @@
+// Simulation.hpp
+#pragma once
+#include "Player.hpp"
+#include "Map.hpp"
+#include "Input.hpp"
+#include <cstdint>
+
+// One fixed simulation step: movement and turning from input, dash timers,
+// and the targets a dash reaches. It reads nothing but its arguments (no
+// clock, no keyboard, no rendered frame), so the same inputs from the same
+// start replay to the same state bit for bit. Returns the points scored.
+int stepSimulation(Player& player, Map& map, const InputState& input, float deltaTime);
+
+// Hash of everything a step changes: the player's pose and dash state, the
+// score and every target's state
+std::uint64_t hashSimulationState(const Player& player, const Map& map, int score);
+
+// Hash of the map's size, walls and targets, to check a replay starts from
+// the map it was recorded on
+std::uint64_t hashMapLayout(const Map& map);
@@ -0,0 +1,522 @@
+// SpanShader.cpp
+#include "SpanShader.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPAN_SHADER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Gain for one pixel, Q7. Shared by the scalar path and the SIMD tails.
+inline int spanGain(int y, const SpanProfile& profile)
+{
+    // Offset from the center normalized to [-1, 1], Q10
+    int r = ((2 * y - profile.center2) * profile.reciprocal) >> 18;
+    int gain = profile.baseQ7 - ((profile.falloffQ8 * (r * r)) >> 21);
+    return std::min(255, std::max(0, gain));
+}
+
+inline Pixel scalePixel(Pixel color, int gain)
+{
+    int r = std::min(255, (pixelRed(color) * gain) >> 7);
+    int g = std::min(255, (pixelGreen(color) * gain) >> 7);
+    int b = std::min(255, (pixelBlue(color) * gain) >> 7);
+    return packColor(static_cast<std::uint8_t>(r), static_cast<std::uint8_t>(g), static_cast<std::uint8_t>(b));
+}
+
+#if SPAN_SHADER_X86
+
+__attribute__((target("sse4.2")))
+void shadeSpanSSE42(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, Pixel color, const SpanProfile& profile)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i maxGain = _mm_set1_epi32(255);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i center2 = _mm_set1_epi32(profile.center2);
+    const __m128i reciprocal = _mm_set1_epi32(profile.reciprocal);
+    const __m128i base = _mm_set1_epi32(profile.baseQ7);
+    const __m128i falloff = _mm_set1_epi32(profile.falloffQ8);
+
+    // Two copies of the color widened to 16-bit channels
+    const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+
+    __m128i y2 = _mm_setr_epi32(2 * yBegin, 2 * yBegin + 2, 2 * yBegin + 4, 2 * yBegin + 6);
+    const __m128i step = _mm_set1_epi32(8);
+
+    int y = yBegin;
+    for (; y + 4 <= yEnd; y += 4) {
+        __m128i r = _mm_srai_epi32(_mm_mullo_epi32(_mm_sub_epi32(y2, center2), reciprocal), 18);
+        __m128i gain = _mm_sub_epi32(base, _mm_srai_epi32(_mm_mullo_epi32(falloff, _mm_mullo_epi32(r, r)), 21));
+        gain = _mm_min_epi32(_mm_max_epi32(gain, zero), maxGain);
+
+        // Repeat each pixel's gain across its four 16-bit channels
+        __m128i gain16 = _mm_packs_epi32(gain, gain);
+        gain16 = _mm_unpacklo_epi16(gain16, gain16);
+        __m128i gainLo = _mm_unpacklo_epi32(gain16, gain16);
+        __m128i gainHi = _mm_unpackhi_epi32(gain16, gain16);
+
+        // color * gain >> 7, then saturate back to bytes
+        __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(color16, gainLo), 7);
+        __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(color16, gainHi), 7);
+        __m128i pixels = _mm_or_si128(_mm_packus_epi16(lo, hi), alpha);
+
+        Pixel* out = dst + (y - yBegin) * stride;
+        if (stride == 1) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), pixels);
+        } else {
+            alignas(16) Pixel lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), pixels);
+            for (int i = 0; i < 4; i++) out[i * stride] = lanes[i];
+        }
+
+        y2 = _mm_add_epi32(y2, step);
+    }
+
+    for (; y < yEnd; y++) {
+        dst[(y - yBegin) * stride] = scalePixel(color, spanGain(y, profile));
+    }
+}
+
+__attribute__((target("avx2")))
+void shadeSpanAVX2(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, Pixel color, const SpanProfile& profile)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i maxGain = _mm256_set1_epi32(255);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i center2 = _mm256_set1_epi32(profile.center2);
+    const __m256i reciprocal = _mm256_set1_epi32(profile.reciprocal);
+    const __m256i base = _mm256_set1_epi32(profile.baseQ7);
+    const __m256i falloff = _mm256_set1_epi32(profile.falloffQ8);
+
+    // One pixel's channels widened to 16 bits, repeated in every 64-bit lane
+    long long color16 = static_cast<long long>(pixelRed(color)) |
+                        (static_cast<long long>(pixelGreen(color)) << 16) |
+                        (static_cast<long long>(pixelBlue(color)) << 32) |
+                        (static_cast<long long>(pixelAlpha(color)) << 48);
+    const __m256i colorWide = _mm256_set1_epi64x(color16);
+
+    __m256i y2 = _mm256_setr_epi32(2 * yBegin, 2 * yBegin + 2, 2 * yBegin + 4, 2 * yBegin + 6,
+                                   2 * yBegin + 8, 2 * yBegin + 10, 2 * yBegin + 12, 2 * yBegin + 14);
+    const __m256i step = _mm256_set1_epi32(16);
+
+    int y = yBegin;
+    for (; y + 8 <= yEnd; y += 8) {
+        __m256i r = _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(y2, center2), reciprocal), 18);
+        __m256i gain = _mm256_sub_epi32(base, _mm256_srai_epi32(_mm256_mullo_epi32(falloff, _mm256_mullo_epi32(r, r)), 21));
+        gain = _mm256_min_epi32(_mm256_max_epi32(gain, zero), maxGain);
+
+        // One gain per 64-bit lane, then repeat it across the four 16-bit channels
+        __m256i gainA = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(gain));
+        __m256i gainB = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(gain, 1));
+        gainA = _mm256_or_si256(gainA, _mm256_slli_epi64(gainA, 16));
+        gainA = _mm256_or_si256(gainA, _mm256_slli_epi64(gainA, 32));
+        gainB = _mm256_or_si256(gainB, _mm256_slli_epi64(gainB, 16));
+        gainB = _mm256_or_si256(gainB, _mm256_slli_epi64(gainB, 32));
+
+        __m256i a = _mm256_srli_epi16(_mm256_mullo_epi16(colorWide, gainA), 7);   // pixels 0-3
+        __m256i b = _mm256_srli_epi16(_mm256_mullo_epi16(colorWide, gainB), 7);   // pixels 4-7
+
+        // packus works per 128-bit lane: qwords come out as 0-1, 4-5, 2-3, 6-7
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        __m256i pixels = _mm256_or_si256(packed, alpha);
+
+        Pixel* out = dst + (y - yBegin) * stride;
+        if (stride == 1) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), pixels);
+        } else {
+            alignas(32) Pixel lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), pixels);
+            for (int i = 0; i < 8; i++) out[i * stride] = lanes[i];
+        }
+
+        y2 = _mm256_add_epi32(y2, step);
+    }
+
+    for (; y < yEnd; y++) {
+        dst[(y - yBegin) * stride] = scalePixel(color, spanGain(y, profile));
+    }
+}
+
+// Textured kernels: the same gain as the flat ones, applied to a texel per pixel
+
+__attribute__((target("sse4.2")))
+void shadeTexturedSpanSSE42(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, const Pixel* texels,
+                            int vStart, int vStep, const SpanProfile& profile)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i maxGain = _mm_set1_epi32(255);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i center2 = _mm_set1_epi32(profile.center2);
+    const __m128i reciprocal = _mm_set1_epi32(profile.reciprocal);
+    const __m128i base = _mm_set1_epi32(profile.baseQ7);
+    const __m128i falloff = _mm_set1_epi32(profile.falloffQ8);
+
+    __m128i y2 = _mm_setr_epi32(2 * yBegin, 2 * yBegin + 2, 2 * yBegin + 4, 2 * yBegin + 6);
+    const __m128i step = _mm_set1_epi32(8);
+
+    int y = yBegin;
+    int v = vStart;
+    for (; y + 4 <= yEnd; y += 4, v += 4 * vStep) {
+        __m128i r = _mm_srai_epi32(_mm_mullo_epi32(_mm_sub_epi32(y2, center2), reciprocal), 18);
+        __m128i gain = _mm_sub_epi32(base, _mm_srai_epi32(_mm_mullo_epi32(falloff, _mm_mullo_epi32(r, r)), 21));
+        gain = _mm_min_epi32(_mm_max_epi32(gain, zero), maxGain);
+
+        __m128i gain16 = _mm_packs_epi32(gain, gain);
+        gain16 = _mm_unpacklo_epi16(gain16, gain16);
+        __m128i gainLo = _mm_unpacklo_epi32(gain16, gain16);
+        __m128i gainHi = _mm_unpackhi_epi32(gain16, gain16);
+
+        // No gather before AVX2: load the four texels one by one
+        __m128i texel = _mm_setr_epi32(static_cast<int>(texels[v >> 16]),
+                                       static_cast<int>(texels[(v + vStep) >> 16]),
+                                       static_cast<int>(texels[(v + 2 * vStep) >> 16]),
+                                       static_cast<int>(texels[(v + 3 * vStep) >> 16]));
+
+        __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(texel, zero), gainLo), 7);
+        __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(texel, zero), gainHi), 7);
+        __m128i pixels = _mm_or_si128(_mm_packus_epi16(lo, hi), alpha);
+
+        Pixel* out = dst + (y - yBegin) * stride;
+        if (stride == 1) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), pixels);
+        } else {
+            alignas(16) Pixel lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), pixels);
+            for (int i = 0; i < 4; i++) out[i * stride] = lanes[i];
+        }
+
+        y2 = _mm_add_epi32(y2, step);
+    }
+
+    for (; y < yEnd; y++, v += vStep) {
+        dst[(y - yBegin) * stride] = scalePixel(texels[v >> 16], spanGain(y, profile));
+    }
+}
+
+__attribute__((target("avx2")))
+void shadeTexturedSpanAVX2(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, const Pixel* texels,
+                           int vStart, int vStep, const SpanProfile& profile)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i maxGain = _mm256_set1_epi32(255);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i center2 = _mm256_set1_epi32(profile.center2);
+    const __m256i reciprocal = _mm256_set1_epi32(profile.reciprocal);
+    const __m256i base = _mm256_set1_epi32(profile.baseQ7);
+    const __m256i falloff = _mm256_set1_epi32(profile.falloffQ8);
+
+    __m256i y2 = _mm256_setr_epi32(2 * yBegin, 2 * yBegin + 2, 2 * yBegin + 4, 2 * yBegin + 6,
+                                   2 * yBegin + 8, 2 * yBegin + 10, 2 * yBegin + 12, 2 * yBegin + 14);
+    const __m256i step = _mm256_set1_epi32(16);
+
+    // Texel coordinates of the eight pixels, Q16
+    __m256i v8 = _mm256_add_epi32(_mm256_set1_epi32(vStart),
+                                  _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                                     _mm256_set1_epi32(vStep)));
+    const __m256i vStep8 = _mm256_set1_epi32(8 * vStep);
+
+    int y = yBegin;
+    int v = vStart;
+    for (; y + 8 <= yEnd; y += 8, v += 8 * vStep) {
+        __m256i r = _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(y2, center2), reciprocal), 18);
+        __m256i gain = _mm256_sub_epi32(base, _mm256_srai_epi32(_mm256_mullo_epi32(falloff, _mm256_mullo_epi32(r, r)), 21));
+        gain = _mm256_min_epi32(_mm256_max_epi32(gain, zero), maxGain);
+
+        __m256i gainA = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(gain));
+        __m256i gainB = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(gain, 1));
+        gainA = _mm256_or_si256(gainA, _mm256_slli_epi64(gainA, 16));
+        gainA = _mm256_or_si256(gainA, _mm256_slli_epi64(gainA, 32));
+        gainB = _mm256_or_si256(gainB, _mm256_slli_epi64(gainB, 16));
+        gainB = _mm256_or_si256(gainB, _mm256_slli_epi64(gainB, 32));
+
+        __m256i texel = _mm256_i32gather_epi32(reinterpret_cast<const int*>(texels),
+                                               _mm256_srai_epi32(v8, 16), 4);
+        __m256i a = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(texel));         // pixels 0-3
+        __m256i b = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(texel, 1));    // pixels 4-7
+        a = _mm256_srli_epi16(_mm256_mullo_epi16(a, gainA), 7);
+        b = _mm256_srli_epi16(_mm256_mullo_epi16(b, gainB), 7);
+
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        __m256i pixels = _mm256_or_si256(packed, alpha);
+
+        Pixel* out = dst + (y - yBegin) * stride;
+        if (stride == 1) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), pixels);
+        } else {
+            alignas(32) Pixel lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), pixels);
+            for (int i = 0; i < 8; i++) out[i * stride] = lanes[i];
+        }
+
+        y2 = _mm256_add_epi32(y2, step);
+        v8 = _mm256_add_epi32(v8, vStep8);
+    }
+
+    for (; y < yEnd; y++, v += vStep) {
+        dst[(y - yBegin) * stride] = scalePixel(texels[v >> 16], spanGain(y, profile));
+    }
+}
+
+// Grid kernels: every lane steps its grid position by eight (four) pixels at a
+// time; the position wraps like unsigned ints so all kernels agree on overflow
+
+__attribute__((target("sse4.2")))
+void shadeGridRowSSE42(Pixel* dst, int count, const int* rowStarts, int row, int u, int v, int du, int dv,
+                       int lineWidth, Pixel baseColor, Pixel lineColor)
+{
+    const __m128i fraction = _mm_set1_epi32(0xFFFF);
+    const __m128i width = _mm_set1_epi32(lineWidth);
+    const __m128i base = _mm_set1_epi32(static_cast<int>(baseColor));
+    const __m128i line = _mm_set1_epi32(static_cast<int>(lineColor));
+    const __m128i rowVector = _mm_set1_epi32(row);
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+    __m128i u4 = _mm_add_epi32(_mm_set1_epi32(u), _mm_mullo_epi32(lanes, _mm_set1_epi32(du)));
+    __m128i v4 = _mm_add_epi32(_mm_set1_epi32(v), _mm_mullo_epi32(lanes, _mm_set1_epi32(dv)));
+    const __m128i uStep = _mm_set1_epi32(static_cast<int>(4u * static_cast<unsigned>(du)));
+    const __m128i vStep = _mm_set1_epi32(static_cast<int>(4u * static_cast<unsigned>(dv)));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i onLine = _mm_or_si128(_mm_cmpgt_epi32(width, _mm_and_si128(u4, fraction)),
+                                      _mm_cmpgt_epi32(width, _mm_and_si128(v4, fraction)));
+        __m128i color = _mm_blendv_epi8(base, line, onLine);
+
+        // Keep what the column drew over this row
+        __m128i covered = _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rowStarts + i)), rowVector);
+        __m128i* out = reinterpret_cast<__m128i*>(dst + i);
+        _mm_storeu_si128(out, _mm_blendv_epi8(color, _mm_loadu_si128(out), covered));
+
+        u4 = _mm_add_epi32(u4, uStep);
+        v4 = _mm_add_epi32(v4, vStep);
+    }
+
+    std::uint32_t tailU = static_cast<std::uint32_t>(u) + static_cast<std::uint32_t>(i) * static_cast<std::uint32_t>(du);
+    std::uint32_t tailV = static_cast<std::uint32_t>(v) + static_cast<std::uint32_t>(i) * static_cast<std::uint32_t>(dv);
+    shadeGridRowScalar(dst + i, count - i, rowStarts + i, row, static_cast<int>(tailU), static_cast<int>(tailV),
+                       du, dv, lineWidth, baseColor, lineColor);
+}
+
+__attribute__((target("avx2")))
+void shadeGridRowAVX2(Pixel* dst, int count, const int* rowStarts, int row, int u, int v, int du, int dv,
+                      int lineWidth, Pixel baseColor, Pixel lineColor)
+{
+    const __m256i fraction = _mm256_set1_epi32(0xFFFF);
+    const __m256i width = _mm256_set1_epi32(lineWidth);
+    const __m256i base = _mm256_set1_epi32(static_cast<int>(baseColor));
+    const __m256i line = _mm256_set1_epi32(static_cast<int>(lineColor));
+    const __m256i rowVector = _mm256_set1_epi32(row);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    __m256i u8 = _mm256_add_epi32(_mm256_set1_epi32(u), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(du)));
+    __m256i v8 = _mm256_add_epi32(_mm256_set1_epi32(v), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(dv)));
+    const __m256i uStep = _mm256_set1_epi32(static_cast<int>(8u * static_cast<unsigned>(du)));
+    const __m256i vStep = _mm256_set1_epi32(static_cast<int>(8u * static_cast<unsigned>(dv)));
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i onLine = _mm256_or_si256(_mm256_cmpgt_epi32(width, _mm256_and_si256(u8, fraction)),
+                                         _mm256_cmpgt_epi32(width, _mm256_and_si256(v8, fraction)));
+        __m256i color = _mm256_blendv_epi8(base, line, onLine);
+
+        __m256i covered = _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowStarts + i)), rowVector);
+        __m256i* out = reinterpret_cast<__m256i*>(dst + i);
+        _mm256_storeu_si256(out, _mm256_blendv_epi8(color, _mm256_loadu_si256(out), covered));
+
+        u8 = _mm256_add_epi32(u8, uStep);
+        v8 = _mm256_add_epi32(v8, vStep);
+    }
+
+    std::uint32_t tailU = static_cast<std::uint32_t>(u) + static_cast<std::uint32_t>(i) * static_cast<std::uint32_t>(du);
+    std::uint32_t tailV = static_cast<std::uint32_t>(v) + static_cast<std::uint32_t>(i) * static_cast<std::uint32_t>(dv);
+    shadeGridRowScalar(dst + i, count - i, rowStarts + i, row, static_cast<int>(tailU), static_cast<int>(tailV),
+                       du, dv, lineWidth, baseColor, lineColor);
+}
+
+#endif // SPAN_SHADER_X86
+
+SpanShaderLevel detectSpanShaderLevel()
+{
+#if SPAN_SHADER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SpanShaderLevel::AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return SpanShaderLevel::SSE42;
+#endif
+    return SpanShaderLevel::Scalar;
+}
+
+SpanShaderLevel supportedLevel()
+{
+    static const SpanShaderLevel level = detectSpanShaderLevel();
+    return level;
+}
+
+SpanShaderLevel& activeLevel()
+{
+    static SpanShaderLevel level = supportedLevel();
+    return level;
+}
+
+} // namespace
+
+SpanProfile makeSpanProfile(int spanStart, int spanEnd, float base, float falloff)
+{
+    int length = std::max(1, spanEnd - spanStart);
+
+    SpanProfile profile;
+    profile.center2 = 2 * spanStart + length;
+    profile.reciprocal = (1 << 28) / length;
+    profile.baseQ7 = static_cast<int>(std::lround(base * 128.0f));
+    profile.falloffQ8 = static_cast<int>(std::lround(falloff * 0.25f * 256.0f));
+    return profile;
+}
+
+SpanShaderLevel getSpanShaderLevel()
+{
+    return activeLevel();
+}
+
+bool isSpanShaderLevelSupported(SpanShaderLevel level)
+{
+    return static_cast<int>(level) <= static_cast<int>(supportedLevel());
+}
+
+const char* getSpanShaderLevelName(SpanShaderLevel level)
+{
+    switch (level) {
+        case SpanShaderLevel::AVX2: return "avx2";
+        case SpanShaderLevel::SSE42: return "sse4.2";
+        default: return "scalar";
+    }
+}
+
+bool setSpanShaderLevel(SpanShaderLevel level)
+{
+    if (!isSpanShaderLevelSupported(level)) return false;
+    activeLevel() = level;
+    return true;
+}
+
+void shadeSpanScalar(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, Pixel color, const SpanProfile& profile)
+{
+    for (int y = yBegin; y < yEnd; y++) {
+        dst[(y - yBegin) * stride] = scalePixel(color, spanGain(y, profile));
+    }
+}
+
+void shadeSpanWithLevel(SpanShaderLevel level, Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd,
+                        Pixel color, const SpanProfile& profile)
+{
+    if (!isSpanShaderLevelSupported(level)) {
+        level = SpanShaderLevel::Scalar;
+    }
+
+#if SPAN_SHADER_X86
+    switch (level) {
+        case SpanShaderLevel::AVX2:
+            shadeSpanAVX2(dst, stride, yBegin, yEnd, color, profile);
+            return;
+        case SpanShaderLevel::SSE42:
+            shadeSpanSSE42(dst, stride, yBegin, yEnd, color, profile);
+            return;
+        default:
+            break;
+    }
+#else
+    (void)level;
+#endif
+    shadeSpanScalar(dst, stride, yBegin, yEnd, color, profile);
+}
+
+void shadeSpan(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, Pixel color, const SpanProfile& profile)
+{
+    shadeSpanWithLevel(activeLevel(), dst, stride, yBegin, yEnd, color, profile);
+}
+
+void shadeTexturedSpanScalar(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, const Pixel* texels,
+                             int vStart, int vStep, const SpanProfile& profile)
+{
+    int v = vStart;
+    for (int y = yBegin; y < yEnd; y++, v += vStep) {
+        dst[(y - yBegin) * stride] = scalePixel(texels[v >> 16], spanGain(y, profile));
+    }
+}
+
+void shadeTexturedSpanWithLevel(SpanShaderLevel level, Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd,
+                                const Pixel* texels, int vStart, int vStep, const SpanProfile& profile)
+{
+    if (!isSpanShaderLevelSupported(level)) {
+        level = SpanShaderLevel::Scalar;
+    }
+
+#if SPAN_SHADER_X86
+    switch (level) {
+        case SpanShaderLevel::AVX2:
+            shadeTexturedSpanAVX2(dst, stride, yBegin, yEnd, texels, vStart, vStep, profile);
+            return;
+        case SpanShaderLevel::SSE42:
+            shadeTexturedSpanSSE42(dst, stride, yBegin, yEnd, texels, vStart, vStep, profile);
+            return;
+        default:
+            break;
+    }
+#else
+    (void)level;
+#endif
+    shadeTexturedSpanScalar(dst, stride, yBegin, yEnd, texels, vStart, vStep, profile);
+}
+
+void shadeTexturedSpan(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, const Pixel* texels,
+                       int vStart, int vStep, const SpanProfile& profile)
+{
+    shadeTexturedSpanWithLevel(activeLevel(), dst, stride, yBegin, yEnd, texels, vStart, vStep, profile);
+}
+
+void shadeGridRowScalar(Pixel* dst, int count, const int* rowStarts, int row, int u, int v, int du, int dv,
+                        int lineWidth, Pixel baseColor, Pixel lineColor)
+{
+    std::uint32_t gridU = static_cast<std::uint32_t>(u);
+    std::uint32_t gridV = static_cast<std::uint32_t>(v);
+    std::uint32_t width = static_cast<std::uint32_t>(std::max(0, lineWidth));
+    for (int i = 0; i < count; i++) {
+        if (row >= rowStarts[i]) {
+            bool onLine = (gridU & 0xFFFF) < width || (gridV & 0xFFFF) < width;
+            dst[i] = onLine ? lineColor : baseColor;
+        }
+        gridU += static_cast<std::uint32_t>(du);
+        gridV += static_cast<std::uint32_t>(dv);
+    }
+}
+
+void shadeGridRowWithLevel(SpanShaderLevel level, Pixel* dst, int count, const int* rowStarts, int row,
+                           int u, int v, int du, int dv, int lineWidth, Pixel baseColor, Pixel lineColor)
+{
+    if (!isSpanShaderLevelSupported(level)) {
+        level = SpanShaderLevel::Scalar;
+    }
+
+#if SPAN_SHADER_X86
+    switch (level) {
+        case SpanShaderLevel::AVX2:
+            shadeGridRowAVX2(dst, count, rowStarts, row, u, v, du, dv, lineWidth, baseColor, lineColor);
+            return;
+        case SpanShaderLevel::SSE42:
+            shadeGridRowSSE42(dst, count, rowStarts, row, u, v, du, dv, lineWidth, baseColor, lineColor);
+            return;
+        default:
+            break;
+    }
+#else
+    (void)level;
+#endif
+    shadeGridRowScalar(dst, count, rowStarts, row, u, v, du, dv, lineWidth, baseColor, lineColor);
+}
+
+void shadeGridRow(Pixel* dst, int count, const int* rowStarts, int row, int u, int v, int du, int dv,
+                  int lineWidth, Pixel baseColor, Pixel lineColor)
+{
+    shadeGridRowWithLevel(activeLevel(), dst, count, rowStarts, row, u, v, du, dv, lineWidth, baseColor, lineColor);
+}
@@ -0,0 +1,63 @@
+// SpanShader.hpp
+#pragma once
+#include "FrameBuffer.hpp"
+#include <cstddef>
+
+// Vertical brightness profile for a wall or target span [start, end):
+//   gain(y) = base - falloff * ((y - center) / length)^2, clamped to [0, 255/128]
+// All fields are fixed point so every kernel produces identical pixels.
+struct SpanProfile {
+    int center2;      // 2 * center of the span (keeps half-pixel centers exact)
+    int reciprocal;   // (1 << 28) / length
+    int baseQ7;       // base gain, Q7
+    int falloffQ8;    // falloff / 4, Q8 (applied to the doubled, normalized offset)
+};
+
+SpanProfile makeSpanProfile(int spanStart, int spanEnd, float base, float falloff);
+
+enum class SpanShaderLevel {
+    Scalar,
+    SSE42,
+    AVX2
+};
+
+// Runtime CPU dispatch picks the widest supported level on first use
+SpanShaderLevel getSpanShaderLevel();
+bool isSpanShaderLevelSupported(SpanShaderLevel level);
+const char* getSpanShaderLevelName(SpanShaderLevel level);
+
+// Force a level (e.g. for benchmarks); returns false if the CPU lacks it.
+// Not thread-safe against concurrent shading.
+bool setSpanShaderLevel(SpanShaderLevel level);
+
+// Shade pixels [yBegin, yEnd) of a column: dst[(y - yBegin) * stride] =
+// color * gain(y), per channel with saturation; alpha is forced opaque.
+void shadeSpan(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, Pixel color, const SpanProfile& profile);
+
+// Portable reference implementation the SIMD kernels must match bit for bit
+void shadeSpanScalar(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, Pixel color, const SpanProfile& profile);
+void shadeSpanWithLevel(SpanShaderLevel level, Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd,
+                        Pixel color, const SpanProfile& profile);
+
+// Textured span: dst[(y - yBegin) * stride] = texels[v >> 16] * gain(y), where v
+// starts at vStart and advances vStep per pixel (both Q16). The caller keeps
+// every index inside texels.
+void shadeTexturedSpan(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, const Pixel* texels,
+                       int vStart, int vStep, const SpanProfile& profile);
+
+void shadeTexturedSpanScalar(Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd, const Pixel* texels,
+                             int vStart, int vStep, const SpanProfile& profile);
+void shadeTexturedSpanWithLevel(SpanShaderLevel level, Pixel* dst, std::ptrdiff_t stride, int yBegin, int yEnd,
+                                const Pixel* texels, int vStart, int vStep, const SpanProfile& profile);
+
+// Floor or ceiling grid along one row. Pixel i is written only where
+// row >= rowStarts[i], i.e. below what its column already drew. It sits at
+// grid position (u + i * du, v + i * dv) in Q16 cells and takes lineColor
+// where either fractional part is below lineWidth (Q16), baseColor elsewhere.
+void shadeGridRow(Pixel* dst, int count, const int* rowStarts, int row, int u, int v, int du, int dv,
+                  int lineWidth, Pixel baseColor, Pixel lineColor);
+
+void shadeGridRowScalar(Pixel* dst, int count, const int* rowStarts, int row, int u, int v, int du, int dv,
+                        int lineWidth, Pixel baseColor, Pixel lineColor);
+void shadeGridRowWithLevel(SpanShaderLevel level, Pixel* dst, int count, const int* rowStarts, int row,
+                           int u, int v, int du, int dv, int lineWidth, Pixel baseColor, Pixel lineColor);
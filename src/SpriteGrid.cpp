@@ -0,0 +1,30 @@
+// SpriteGrid.cpp
+#include "SpriteGrid.hpp"
+
+void SpriteGrid::update(const Map& map)
+{
+    if (map.getRevision() == revision && !blockStarts.empty()) return;
+    revision = map.getRevision();
+
+    const int blockSize = 1 << blockShift;
+    blocksX = std::max(1, (map.getWidth() + blockSize - 1) >> blockShift);
+    blocksY = std::max(1, (map.getHeight() + blockSize - 1) >> blockShift);
+    std::size_t blockCount = static_cast<std::size_t>(blocksX) * blocksY;
+
+    // Counting sort by block: count, prefix sum, then place
+    const std::vector<Target>& targets = map.getTargets();
+    blockStarts.assign(blockCount + 1, 0);
+    for (const Target& target : targets) {
+        blockStarts[(target.y >> blockShift) * blocksX + (target.x >> blockShift) + 1]++;
+    }
+    for (std::size_t b = 0; b < blockCount; b++) {
+        blockStarts[b + 1] += blockStarts[b];
+    }
+
+    entries.resize(targets.size());
+    std::vector<int> next(blockStarts.begin(), blockStarts.end() - 1);
+    for (std::size_t i = 0; i < targets.size(); i++) {
+        const Target& target = targets[i];
+        entries[next[(target.y >> blockShift) * blocksX + (target.x >> blockShift)]++] = static_cast<int>(i);
+    }
+}
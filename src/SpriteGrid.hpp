@@ -0,0 +1,43 @@
+// SpriteGrid.hpp
+#pragma once
+#include "Map.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Map targets binned into square blocks of cells, so a view only visits the
+// targets in blocks it can see instead of every target in the map.
+class SpriteGrid {
+public:
+    static const int blockShift = 3;               // 8x8 cells per block
+
+    // Rebuild from the map's targets if the map changed since the last call
+    void update(const Map& map);
+
+    // Call fn(targetIndex) for each target in a block overlapping cells
+    // [minX, maxX] x [minY, maxY]. Blocks are visited in order, so the
+    // sequence is the same every time for the same rectangle.
+    template <typename Fn>
+    void forEachInRect(int minX, int minY, int maxX, int maxY, Fn&& fn) const
+    {
+        int blockMinX = std::max(0, minX >> blockShift);
+        int blockMinY = std::max(0, minY >> blockShift);
+        int blockMaxX = std::min(blocksX - 1, maxX >> blockShift);
+        int blockMaxY = std::min(blocksY - 1, maxY >> blockShift);
+
+        for (int by = blockMinY; by <= blockMaxY; by++) {
+            const int* row = blockStarts.data() + by * blocksX;
+            for (int bx = blockMinX; bx <= blockMaxX; bx++) {
+                for (int i = row[bx]; i < row[bx + 1]; i++) {
+                    fn(entries[i]);
+                }
+            }
+        }
+    }
+
+private:
+    std::uint64_t revision = 0;                    // Map::getRevision() of the current bins
+    int blocksX = 0, blocksY = 0;
+    std::vector<int> blockStarts;                  // Block b holds entries [blockStarts[b], blockStarts[b + 1])
+    std::vector<int> entries;                      // Target indices, grouped by block
+};
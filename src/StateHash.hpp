@@ -0,0 +1,32 @@
+// StateHash.hpp
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// 64-bit FNV-1a over the exact bytes of simulation values. Floats hash by
+// their bits, so two states hash equal only if they are bit for bit the same.
+class StateHash {
+public:
+    explicit StateHash(std::uint64_t seed = offsetBasis) : value(seed) {}
+
+    template <typename T>
+    StateHash& add(T field)
+    {
+        static_assert(std::is_arithmetic<T>::value, "StateHash takes numbers and bools");
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &field, sizeof(T));
+        for (unsigned char byte : bytes) {
+            value = (value ^ byte) * prime;
+        }
+        return *this;
+    }
+
+    std::uint64_t get() const { return value; }
+
+    static const std::uint64_t offsetBasis = 0xcbf29ce484222325ull;
+
+private:
+    static const std::uint64_t prime = 0x100000001b3ull;
+    std::uint64_t value;
+};
@@ -0,0 +1,278 @@
+// StreamingWorld.cpp
+#include "StreamingWorld.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+// Rounds towards negative infinity, unlike /
+int floorDiv(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+} // namespace
+
+StreamingWorld::StreamingWorld(std::unique_ptr<ChunkSource> source, int windowChunks, std::size_t memoryBudget)
+    : source(std::move(source)),
+      windowChunks(std::max(3, windowChunks | 1)),
+      memoryBudget(memoryBudget),
+      origin(0, 0)
+{
+    loader = std::thread(&StreamingWorld::loaderLoop, this);
+}
+
+StreamingWorld::~StreamingWorld()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    loader.join();
+}
+
+void StreamingWorld::loaderLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !requests.empty(); });
+        if (stopping) return;
+
+        loading = requests.back();
+        requests.pop_back();
+        busy = true;
+        lock.unlock();
+
+        WorldChunk chunk;
+        bool exists = source->loadChunk(worldChunkX(loading), worldChunkY(loading), chunkSize, chunk);
+
+        lock.lock();
+        if (exists) {
+            loaded.emplace_back(loading, std::move(chunk));
+        } else {
+            missing.push_back(loading);
+        }
+        busy = false;
+        wake.notify_all();   // start() may be waiting for the loader to go idle
+    }
+}
+
+sf::Vector2f StreamingWorld::start(Map& map, sf::Vector2i start)
+{
+    // Nothing else may call the source while we load the first chunk
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        requests.clear();
+        wake.wait(lock, [this] { return !busy; });
+    }
+
+    sf::Vector2i startChunk(floorDiv(start.x, chunkSize), floorDiv(start.y, chunkSize));
+    origin = startChunk - sf::Vector2i(windowChunks / 2, windowChunks / 2);
+
+    std::uint64_t key = worldChunkKey(startChunk.x, startChunk.y);
+    if (cache.find(key) == cache.end()) {
+        CacheEntry& entry = cache[key];
+        entry.exists = source->loadChunk(startChunk.x, startChunk.y, chunkSize, entry.chunk);
+        recentUse.push_front(key);
+        entry.recent = recentUse.begin();
+        cachedBytes += entryBytes(entry);
+        stats.loads++;
+    }
+
+    int windowCells = windowChunks * chunkSize;
+    map = Map(windowCells, windowCells);
+    fillWindow(map);
+    mapRevision = map.getRevision();
+    windowEdited = false;
+    queueRequests(startChunk);
+
+    // Nearest open cell, searched in growing squares
+    sf::Vector2i local = start - getOrigin();
+    for (int radius = 0; radius < chunkSize; radius++) {
+        for (int y = local.y - radius; y <= local.y + radius; y++) {
+            for (int x = local.x - radius; x <= local.x + radius; x++) {
+                bool ring = std::abs(x - local.x) == radius || std::abs(y - local.y) == radius;
+                if (ring && x >= 0 && y >= 0 && x < windowCells && y < windowCells && !map.isWall(x, y)) {
+                    return sf::Vector2f(x + 0.5f, y + 0.5f);
+                }
+            }
+        }
+    }
+    return sf::Vector2f(local.x + 0.5f, local.y + 0.5f);
+}
+
+sf::Vector2i StreamingWorld::update(Map& map, sf::Vector2f position)
+{
+    windowEdited = windowEdited || map.getRevision() != mapRevision;
+
+    std::vector<std::pair<std::uint64_t, WorldChunk>> arrived;
+    std::vector<std::uint64_t> absent;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        arrived.swap(loaded);
+        absent.swap(missing);
+    }
+
+    for (auto& result : arrived) {
+        if (cache.find(result.first) != cache.end()) continue;
+        CacheEntry& entry = cache[result.first];
+        entry.chunk = std::move(result.second);
+        entry.exists = true;
+        recentUse.push_front(result.first);
+        entry.recent = recentUse.begin();
+        cachedBytes += entryBytes(entry);
+        stats.loads++;
+        if (inWindow(worldChunkX(result.first), worldChunkY(result.first))) {
+            install(map, result.first, entry);
+        }
+    }
+    for (std::uint64_t key : absent) {
+        if (cache.find(key) != cache.end()) continue;
+        CacheEntry& entry = cache[key];
+        recentUse.push_front(key);
+        entry.recent = recentUse.begin();
+        cachedBytes += entryBytes(entry);
+        stats.loads++;
+    }
+
+    // Move the window by whole chunks once the player is more than one
+    // chunk from its centre; a smaller margin would shift back and forth
+    sf::Vector2i playerChunk(static_cast<int>(std::floor(position.x / chunkSize)),
+                             static_cast<int>(std::floor(position.y / chunkSize)));
+    sf::Vector2i offset = playerChunk - sf::Vector2i(windowChunks / 2, windowChunks / 2);
+    sf::Vector2i shift(0, 0);
+    if (std::abs(offset.x) > 1 || std::abs(offset.y) > 1) {
+        storeWindow(map);
+        origin += offset;
+        fillWindow(map);
+        playerChunk -= offset;
+        shift = offset * chunkSize;
+        stats.shifts++;
+    }
+
+    mapRevision = map.getRevision();
+    queueRequests(origin + playerChunk);
+    evict();
+    return shift;
+}
+
+StreamingWorld::Stats StreamingWorld::getStats() const
+{
+    Stats result = stats;
+    result.cachedChunks = static_cast<int>(cache.size());
+    result.cachedBytes = cachedBytes;
+    std::lock_guard<std::mutex> lock(mutex);
+    result.pendingChunks = static_cast<int>(requests.size() + loaded.size() + missing.size()) + (busy ? 1 : 0);
+    return result;
+}
+
+void StreamingWorld::install(Map& map, std::uint64_t key, CacheEntry& entry)
+{
+    int x = (worldChunkX(key) - origin.x) * chunkSize;
+    int y = (worldChunkY(key) - origin.y) * chunkSize;
+    if (entry.exists) {
+        map.setRegion(x, y, chunkSize, chunkSize, entry.chunk.cells.data(), chunkSize, entry.chunk.targets);
+    } else {
+        map.setRegion(x, y, chunkSize, chunkSize, nullptr, 0, {});
+    }
+}
+
+void StreamingWorld::storeWindow(const Map& map)
+{
+    if (!windowEdited) return;
+    windowEdited = false;
+
+    for (int cy = 0; cy < windowChunks; cy++) {
+        for (int cx = 0; cx < windowChunks; cx++) {
+            auto found = cache.find(worldChunkKey(origin.x + cx, origin.y + cy));
+            if (found == cache.end() || !found->second.exists) continue;
+
+            CacheEntry& entry = found->second;
+            cachedBytes -= entryBytes(entry);
+            map.getRegion(cx * chunkSize, cy * chunkSize, chunkSize, chunkSize,
+                          entry.chunk.cells.data(), chunkSize, entry.chunk.targets);
+            cachedBytes += entryBytes(entry);
+        }
+    }
+}
+
+void StreamingWorld::fillWindow(Map& map)
+{
+    // Targets first, so each block below starts out empty
+    map.clearTargets();
+    for (int cy = 0; cy < windowChunks; cy++) {
+        for (int cx = 0; cx < windowChunks; cx++) {
+            std::uint64_t key = worldChunkKey(origin.x + cx, origin.y + cy);
+            auto found = cache.find(key);
+            if (found == cache.end()) {
+                map.setRegion(cx * chunkSize, cy * chunkSize, chunkSize, chunkSize, nullptr, 0, {});
+                continue;
+            }
+            recentUse.splice(recentUse.begin(), recentUse, found->second.recent);
+            install(map, key, found->second);
+        }
+    }
+}
+
+void StreamingWorld::queueRequests(sf::Vector2i centreChunk)
+{
+    // The window plus one ring of chunks around it, so a shift finds its
+    // new chunks already cached
+    int reach = windowChunks / 2 + 1;
+    sf::Vector2i middle = origin + sf::Vector2i(windowChunks / 2, windowChunks / 2);
+    std::vector<std::pair<int, std::uint64_t>> wanted;
+    for (int y = middle.y - reach; y <= middle.y + reach; y++) {
+        for (int x = middle.x - reach; x <= middle.x + reach; x++) {
+            std::uint64_t key = worldChunkKey(x, y);
+            if (cache.find(key) != cache.end()) continue;
+            int dx = x - centreChunk.x, dy = y - centreChunk.y;
+            wanted.emplace_back(dx * dx + dy * dy, key);
+        }
+    }
+    // Farthest first: the loader takes from the back
+    std::sort(wanted.begin(), wanted.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.clear();
+        for (const auto& request : wanted) {
+            std::uint64_t key = request.second;
+            bool delivered = std::any_of(loaded.begin(), loaded.end(), [key](const auto& l) { return l.first == key; }) ||
+                             std::find(missing.begin(), missing.end(), key) != missing.end();
+            if ((busy && key == loading) || delivered) continue;
+            requests.push_back(key);
+        }
+    }
+    wake.notify_one();
+}
+
+void StreamingWorld::evict()
+{
+    // Least recently used first; the window itself stays
+    auto it = recentUse.end();
+    while (cachedBytes > memoryBudget && it != recentUse.begin()) {
+        --it;
+        std::uint64_t key = *it;
+        if (inWindow(worldChunkX(key), worldChunkY(key))) continue;
+
+        auto found = cache.find(key);
+        cachedBytes -= entryBytes(found->second);
+        cache.erase(found);
+        it = recentUse.erase(it);
+        stats.evictions++;
+    }
+}
+
+bool StreamingWorld::inWindow(int chunkX, int chunkY) const
+{
+    return chunkX >= origin.x && chunkX < origin.x + windowChunks &&
+           chunkY >= origin.y && chunkY < origin.y + windowChunks;
+}
+
+std::size_t StreamingWorld::entryBytes(const CacheEntry& entry) const
+{
+    // Rough per-entry bookkeeping (hash node, list node) on top of the data
+    return 64 + entry.chunk.cells.capacity() + entry.chunk.targets.capacity() * sizeof(Target);
+}
@@ -0,0 +1,105 @@
+// StreamingWorld.hpp
+#pragma once
+#include "ChunkSource.hpp"
+#include "Map.hpp"
+#include <SFML/System/Vector2.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// A world larger than memory, streamed through a Map in chunks.
+//
+// The Map holds a window of windowChunks x windowChunks chunks around the
+// player; map coordinates are world coordinates minus getOrigin(). Rays and
+// collisions only ever see that flat grid, so crossing chunk boundaries
+// costs nothing. Chunks are loaded on a background thread, nearest first;
+// until a chunk arrives its cells are solid wall. Loaded chunks stay cached
+// (edits included) until the cache passes its memory budget, then the least
+// recently used chunks outside the window are dropped.
+class StreamingWorld {
+public:
+    static const int chunkSize = 64;                   // Cells per chunk side
+
+    struct Stats {
+        int cachedChunks = 0;
+        std::size_t cachedBytes = 0;
+        int pendingChunks = 0;      // Wanted but not loaded yet
+        long long loads = 0;        // Chunks delivered by the source so far
+        long long evictions = 0;
+        long long shifts = 0;       // Times the window moved
+    };
+
+    // windowChunks is rounded up to an odd number, at least 3. The budget
+    // never evicts chunks inside the window, so the cache can exceed it by
+    // up to the window's own size.
+    StreamingWorld(std::unique_ptr<ChunkSource> source, int windowChunks = 9,
+                   std::size_t memoryBudget = std::size_t(32) << 20);
+    ~StreamingWorld();
+
+    StreamingWorld(const StreamingWorld&) = delete;
+    StreamingWorld& operator=(const StreamingWorld&) = delete;
+
+    // Size the map to the window and centre it on world cell start. The
+    // chunk under start is loaded before this returns. Returns the open cell
+    // nearest to start, in map coordinates (the middle of that cell).
+    sf::Vector2f start(Map& map, sf::Vector2i start);
+
+    // Call once per frame with the player's map position: installs loaded
+    // chunks, queues the ones now wanted, and moves the window once the
+    // player is more than a chunk away from its centre. Returns how far map
+    // coordinates moved, in cells; subtract it from everything positioned in
+    // map coordinates.
+    sf::Vector2i update(Map& map, sf::Vector2f position);
+
+    sf::Vector2i getOrigin() const { return origin * chunkSize; }  // World cell of map (0, 0)
+    bool isChunkLoaded(int chunkX, int chunkY) const { return cache.count(worldChunkKey(chunkX, chunkY)) > 0; }
+    Stats getStats() const;
+
+private:
+    struct CacheEntry {
+        WorldChunk chunk;
+        bool exists = false;                           // The source has this chunk
+        std::list<std::uint64_t>::iterator recent;     // Position in recentUse
+    };
+
+    // Loader thread: takes the nearest request, loads it, hands it back
+    void loaderLoop();
+
+    void install(Map& map, std::uint64_t key, CacheEntry& entry);
+    void storeWindow(const Map& map);           // Write map edits back to the cache
+    void fillWindow(Map& map);
+    void queueRequests(sf::Vector2i centreChunk);
+    void evict();
+    bool inWindow(int chunkX, int chunkY) const;
+    std::size_t entryBytes(const CacheEntry& entry) const;
+
+    std::unique_ptr<ChunkSource> source;
+    int windowChunks;
+    std::size_t memoryBudget;
+    sf::Vector2i origin;                        // Chunk at map (0, 0)
+
+    // Main thread only
+    std::unordered_map<std::uint64_t, CacheEntry> cache;
+    std::list<std::uint64_t> recentUse;         // Most recent first
+    std::size_t cachedBytes = 0;
+    std::uint64_t mapRevision = 0;              // Map revision after our own last change
+    bool windowEdited = false;                  // The game changed the map since the last store
+    Stats stats;
+
+    // Shared with the loader thread
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::uint64_t> requests;        // Nearest last
+    std::vector<std::pair<std::uint64_t, WorldChunk>> loaded;
+    std::vector<std::uint64_t> missing;         // Chunks the source doesn't have
+    std::uint64_t loading = 0;                  // Key being loaded, if busy
+    bool busy = false;
+    bool stopping = false;
+    std::thread loader;
+};
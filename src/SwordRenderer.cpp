@@ -1,10 +1,10 @@
 // SwordRenderer.cpp
 #include "SwordRenderer.hpp"
 
-void SwordRenderer::draw(sf::Image& frameBuffer, const Player& player)
+void SwordRenderer::draw(FrameBuffer& frameBuffer, const Player& player)
 {
-    int screenWidth = frameBuffer.getSize().x;
-    int screenHeight = frameBuffer.getSize().y;
+    int screenWidth = frameBuffer.getWidth();
+    int screenHeight = frameBuffer.getHeight();
 
     int swordWidth = screenWidth * 0.3f;
     int swordHeight = screenHeight * 0.2f;
@@ -16,42 +16,17 @@ void SwordRenderer::draw(sf::Image& frameBuffer, const Player& player)
     int pommelHeight = swordHeight * 0.1f;
 
     int edgeThickness = 3; // thickness of the neon edge
-    sf::Color neonCyan(0, 255, 255);
+    Pixel neonCyan = packColor(0, 255, 255);
 
+    // Each edge is a clipped row/column span fill
     auto drawHollowRect = [&](int x, int y, int w, int h) {
         // Top and Bottom edges
-        for (int i = 0; i < edgeThickness; ++i) {
-            for (int dx = 0; dx < w; ++dx) {
-                // Top edge
-                int pxTop = x + dx;
-                int pyTop = y + i;
-                if (pxTop >= 0 && pxTop < screenWidth && pyTop >= 0 && pyTop < screenHeight)
-                    frameBuffer.setPixel({static_cast<unsigned>(pxTop), static_cast<unsigned>(pyTop)}, neonCyan);
-
-                // Bottom edge
-                int pxBot = x + dx;
-                int pyBot = y + h - 1 - i;
-                if (pxBot >= 0 && pxBot < screenWidth && pyBot >= 0 && pyBot < screenHeight)
-                    frameBuffer.setPixel({static_cast<unsigned>(pxBot), static_cast<unsigned>(pyBot)}, neonCyan);
-            }
-        }
+        frameBuffer.fillRect(x, y, w, edgeThickness, neonCyan);
+        frameBuffer.fillRect(x, y + h - edgeThickness, w, edgeThickness, neonCyan);
 
         // Left and Right edges
-        for (int i = 0; i < edgeThickness; ++i) {
-            for (int dy = 0; dy < h; ++dy) {
-                // Left edge
-                int pxLeft = x + i;
-                int pyLeft = y + dy;
-                if (pxLeft >= 0 && pxLeft < screenWidth && pyLeft >= 0 && pyLeft < screenHeight)
-                    frameBuffer.setPixel({static_cast<unsigned>(pxLeft), static_cast<unsigned>(pyLeft)}, neonCyan);
-
-                // Right edge
-                int pxRight = x + w - 1 - i;
-                int pyRight = y + dy;
-                if (pxRight >= 0 && pxRight < screenWidth && pyRight >= 0 && pyRight < screenHeight)
-                    frameBuffer.setPixel({static_cast<unsigned>(pxRight), static_cast<unsigned>(pyRight)}, neonCyan);
-            }
-        }
+        frameBuffer.fillRect(x, y, edgeThickness, h, neonCyan);
+        frameBuffer.fillRect(x + w - edgeThickness, y, edgeThickness, h, neonCyan);
     };
 
     // Draw Blade (top part)
@@ -4,5 +4,5 @@
 
 class SwordRenderer : public WeaponRenderer {
 public:
-    void draw(sf::Image& frameBuffer, const Player& player) override;
+    void draw(FrameBuffer& frameBuffer, const Player& player) override;
 };
@@ -0,0 +1,150 @@
+// ThreadPool.cpp
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : jobGeneration(0),
+      pendingTiles(0),
+      stopping(false)
+{
+    startWorkers(threadCount);
+}
+
+ThreadPool::~ThreadPool()
+{
+    stopWorkers();
+}
+
+void ThreadPool::setThreadCount(unsigned threadCount)
+{
+    stopWorkers();
+    startWorkers(threadCount);
+}
+
+void ThreadPool::startWorkers(unsigned threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    stopping = false;
+    queues.clear();
+    for (unsigned i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<TileQueue>());
+    }
+
+    // The calling thread is worker 0, so spawn one fewer
+    for (unsigned i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, static_cast<size_t>(i));
+    }
+}
+
+void ThreadPool::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void ThreadPool::parallelFor(int begin, int end, int tileSize, const TileFunction& fn)
+{
+    if (end <= begin) return;
+
+    tileSize = std::max(1, tileSize);
+    int tileCount = (end - begin + tileSize - 1) / tileSize;
+
+    // Nothing to share - skip the handoff entirely
+    if (workers.empty() || tileCount == 1) {
+        fn(begin, end);
+        return;
+    }
+
+    // Hand each queue a contiguous run of tiles so neighbouring columns stay on one core
+    size_t queueCount = queues.size();
+    pendingTiles.store(tileCount);
+    for (size_t q = 0; q < queueCount; q++) {
+        int firstTile = static_cast<int>(tileCount * q / queueCount);
+        int lastTile = static_cast<int>(tileCount * (q + 1) / queueCount);
+
+        std::lock_guard<std::mutex> lock(queues[q]->mutex);
+        for (int t = firstTile; t < lastTile; t++) {
+            int tileBegin = begin + t * tileSize;
+            int tileEnd = std::min(end, tileBegin + tileSize);
+            queues[q]->tiles.push_back({tileBegin, tileEnd, &fn});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobGeneration++;
+    }
+    jobReady.notify_all();
+
+    runTiles(0);
+
+    // Our queue and every steal target are empty; wait for tiles still in flight
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobDone.wait(lock, [this] { return pendingTiles.load() == 0; });
+}
+
+void ThreadPool::workerLoop(size_t queueIndex)
+{
+    std::uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = jobGeneration;
+        }
+        runTiles(queueIndex);
+    }
+}
+
+void ThreadPool::runTiles(size_t queueIndex)
+{
+    Tile tile;
+    while (popLocal(queueIndex, tile) || steal(queueIndex, tile)) {
+        (*tile.fn)(tile.begin, tile.end);
+
+        if (pendingTiles.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            jobDone.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::popLocal(size_t queueIndex, Tile& tile)
+{
+    TileQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tiles.empty()) return false;
+
+    // Owner works front-to-back for locality
+    tile = queue.tiles.front();
+    queue.tiles.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(size_t queueIndex, Tile& tile)
+{
+    size_t queueCount = queues.size();
+    for (size_t offset = 1; offset < queueCount; offset++) {
+        TileQueue& victim = *queues[(queueIndex + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tiles.empty()) continue;
+
+        // Thieves take from the back, away from where the owner is working
+        tile = victim.tiles.back();
+        victim.tiles.pop_back();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,62 @@
+// ThreadPool.hpp
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker pool that runs a range split into tiles.
+// Each worker owns a deque of tiles; idle workers steal from the others,
+// which evens out tiles of uneven cost (e.g. long corridors next to close walls).
+class ThreadPool {
+public:
+    using TileFunction = std::function<void(int begin, int end)>;
+
+    // threadCount includes the calling thread; 0 uses every hardware thread
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void setThreadCount(unsigned threadCount);
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Run fn over [begin, end) in tiles of tileSize; blocks until every tile is done.
+    // The calling thread works on tiles too.
+    void parallelFor(int begin, int end, int tileSize, const TileFunction& fn);
+
+private:
+    struct Tile {
+        int begin;
+        int end;
+        const TileFunction* fn;  // Carried per tile so a late thief never runs a stale job
+    };
+
+    struct TileQueue {
+        std::mutex mutex;
+        std::deque<Tile> tiles;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<TileQueue>> queues;  // One per worker, index 0 is the caller
+
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    std::uint64_t jobGeneration;
+    std::atomic<int> pendingTiles;
+    bool stopping;
+
+    void startWorkers(unsigned threadCount);
+    void stopWorkers();
+    void workerLoop(size_t queueIndex);
+    void runTiles(size_t queueIndex);
+    bool popLocal(size_t queueIndex, Tile& tile);
+    bool steal(size_t queueIndex, Tile& tile);
+};
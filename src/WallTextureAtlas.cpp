@@ -0,0 +1,152 @@
+// WallTextureAtlas.cpp
+#include "WallTextureAtlas.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+WallTextureAtlas::WallTextureAtlas()
+    : textureCount(0)
+{
+    // Pad every level to whole cache lines so the next one stays aligned
+    const std::size_t lineTexels = FrameBuffer::alignment / sizeof(Pixel);
+    std::size_t offset = 0;
+    for (int level = 0; level < levelCount; level++) {
+        levelOffsets[level] = offset;
+        std::size_t size = static_cast<std::size_t>(levelSize(level)) * levelSize(level);
+        offset += (size + lineTexels - 1) / lineTexels * lineTexels;
+    }
+    texelsPerTexture = offset;
+}
+
+int WallTextureAtlas::load(const std::string& directory, int typeCount)
+{
+    textureCount = std::max(1, typeCount + 1);
+    texels.resize(static_cast<int>(texelsPerTexture), textureCount);
+
+    int loaded = 0;
+    for (int texture = 0; texture < textureCount; texture++) {
+        std::vector<Pixel> image;
+        bool fromFile = texture > 0 && texture < typeCount &&
+                        loadImage(directory + "/wall" + std::to_string(texture) + ".png", image);
+        if (fromFile) {
+            loaded++;
+        } else {
+            image = makePanel(texture);
+        }
+        setTexture(texture, image);
+    }
+    return loaded;
+}
+
+int WallTextureAtlas::levelFor(int lineHeight)
+{
+    int level = 0;
+    while (level + 1 < levelCount && levelSize(level + 1) >= lineHeight) {
+        level++;
+    }
+    return level;
+}
+
+void WallTextureAtlas::setTexture(int texture, const std::vector<Pixel>& image)
+{
+    // Level 0: transpose the row-major image
+    Pixel* level0 = texels.row(texture) + levelOffsets[0];
+    for (int u = 0; u < textureSize; u++) {
+        for (int v = 0; v < textureSize; v++) {
+            level0[u * textureSize + v] = image[v * textureSize + u] | 0xFF000000u;
+        }
+    }
+
+    // Each further level averages 2x2 texels of the one above
+    for (int level = 1; level < levelCount; level++) {
+        const Pixel* source = texels.row(texture) + levelOffsets[level - 1];
+        Pixel* destination = texels.row(texture) + levelOffsets[level];
+        int sourceSize = levelSize(level - 1);
+        int size = levelSize(level);
+
+        for (int u = 0; u < size; u++) {
+            for (int v = 0; v < size; v++) {
+                const Pixel* left = source + (2 * u) * sourceSize + 2 * v;
+                const Pixel* right = left + sourceSize;
+                Pixel quad[4] = {left[0], left[1], right[0], right[1]};
+
+                int r = 2, g = 2, b = 2;
+                for (Pixel p : quad) {
+                    r += pixelRed(p);
+                    g += pixelGreen(p);
+                    b += pixelBlue(p);
+                }
+                destination[u * size + v] = packColor(static_cast<std::uint8_t>(r >> 2),
+                                                      static_cast<std::uint8_t>(g >> 2),
+                                                      static_cast<std::uint8_t>(b >> 2));
+            }
+        }
+    }
+}
+
+// Grayscale Tron panel for wall types without a texture file. The wall color
+// tints it, so the pattern only sets brightness.
+std::vector<Pixel> WallTextureAtlas::makePanel(int wallType)
+{
+    std::vector<Pixel> image(static_cast<std::size_t>(textureSize) * textureSize);
+
+    for (int v = 0; v < textureSize; v++) {
+        for (int u = 0; u < textureSize; u++) {
+            // Bright frame on the top and left edge; neighbouring cells close it
+            bool frame = u < 2 || v < 2;
+            bool line = false;
+            int level = 150;
+
+            switch (wallType % 4) {
+                case 1:     // Standard wall: 2x2 panels with a lit seam
+                    line = u % 32 < 2 || v % 32 < 2;
+                    break;
+                case 2:     // Energy wall: horizontal bands, brightest at their centre
+                    level = 110 + 12 * (4 - std::abs(v % 8 - 4));
+                    line = v % 16 == 8;
+                    break;
+                case 3:     // Data streams: dashed vertical channels
+                    line = u % 8 == 4 && (v + u * 5) % 12 < 6;
+                    break;
+                default:    // Diagonal hatching
+                    line = (u + v) % 16 < 2;
+                    break;
+            }
+
+            if (frame) level = 255;
+            else if (line) level = 220;
+
+            std::uint8_t gray = static_cast<std::uint8_t>(level);
+            image[v * textureSize + u] = packColor(gray, gray, gray);
+        }
+    }
+    return image;
+}
+
+// Read an image and resample it to textureSize x textureSize (nearest texel)
+bool WallTextureAtlas::loadImage(const std::string& path, std::vector<Pixel>& image)
+{
+    // A missing file is expected; only a broken one is worth a message
+    if (!std::ifstream(path)) return false;
+
+    sf::Image source;
+    if (!source.loadFromFile(path)) {
+        std::cerr << "Failed to load wall texture " << path << std::endl;
+        return false;
+    }
+
+    sf::Vector2u size = source.getSize();
+    if (size.x == 0 || size.y == 0) {
+        std::cerr << "Wall texture " << path << " is empty" << std::endl;
+        return false;
+    }
+
+    image.resize(static_cast<std::size_t>(textureSize) * textureSize);
+    for (int v = 0; v < textureSize; v++) {
+        for (int u = 0; u < textureSize; u++) {
+            sf::Vector2u texel(u * size.x / textureSize, v * size.y / textureSize);
+            image[v * textureSize + u] = packColor(source.getPixel(texel));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+// WallTextureAtlas.hpp
+#pragma once
+#include "FrameBuffer.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Every wall texture and its mip chain in one block of memory. Levels are
+// stored column-major (texel (u, v) at u * size + v) and start on a cache
+// line, so the strip a screen column samples is one contiguous run.
+class WallTextureAtlas {
+public:
+    static const int textureSize = 64;   // Level 0 is textureSize x textureSize
+    static const int levelCount = 7;     // 64, 32, ..., 1
+
+    WallTextureAtlas();
+
+    // One texture per wall type below typeCount, plus one for unknown types.
+    // Type t is read from <directory>/wall<t>.png; missing files get a
+    // procedural panel. Textures are tinted by the wall color when shaded, so
+    // grayscale art keeps the palette. Returns how many files were loaded.
+    int load(const std::string& directory, int typeCount);
+
+    int getTextureCount() const { return textureCount; }
+
+    // Texture of a wall type; unknown types share the last one
+    int textureFor(int wallType) const { return std::min(std::max(wallType, 0), textureCount - 1); }
+
+    // Mip level for a wall slice lineHeight pixels tall: the smallest level
+    // that still has at least one texel row per pixel row
+    static int levelFor(int lineHeight);
+    static int levelSize(int level) { return textureSize >> level; }
+
+    // Texel column u of one level, levelSize(level) texels from top to bottom
+    const Pixel* column(int texture, int level, int u) const
+    {
+        return texels.row(texture) + levelOffsets[level] + static_cast<std::size_t>(u) * levelSize(level);
+    }
+
+private:
+    // Replace a texture from row-major level 0 texels and rebuild its mips
+    void setTexture(int texture, const std::vector<Pixel>& image);
+
+    static std::vector<Pixel> makePanel(int wallType);
+    static bool loadImage(const std::string& path, std::vector<Pixel>& image);
+
+    int textureCount;
+    std::size_t levelOffsets[levelCount];   // In texels from the start of a texture
+    std::size_t texelsPerTexture;           // A whole number of cache lines
+    FrameBuffer texels;                     // Row t holds texture t, every level
+};
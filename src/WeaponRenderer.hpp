@@ -2,9 +2,10 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include "Player.hpp"
+#include "FrameBuffer.hpp"
 
 class WeaponRenderer {
 public:
     virtual ~WeaponRenderer() = default;
-    virtual void draw(sf::Image& frameBuffer, const Player& player) = 0;
+    virtual void draw(FrameBuffer& frameBuffer, const Player& player) = 0;
 };
@@ -0,0 +1,64 @@
+// MapConverter.cpp
+// Converts maps between the text format and the binary format (MapFile.hpp).
+// The input format is detected from the file; the output format comes from
+// --binary / --text or else the output extension (.rcmap is binary).
+#include "Map.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+bool endsWith(const std::string& text, const std::string& suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " <input> <output> [--binary | --text] [--chunk N]" << std::endl
+              << "Without --binary or --text, writes binary if the output ends in .rcmap." << std::endl
+              << "--chunk sets the chunk index size in cells for binary output (default 64, 0 = none)." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string input, output;
+    int format = 0;           // 1 binary, 2 text, 0 from the extension
+    int chunkSize = 64;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--binary") {
+            format = 1;
+        } else if (arg == "--text") {
+            format = 2;
+        } else if (arg == "--chunk" && i + 1 < argc) {
+            chunkSize = std::max(0, std::atoi(argv[++i]));
+        } else if (arg[0] != '-' && input.empty()) {
+            input = arg;
+        } else if (arg[0] != '-' && output.empty()) {
+            output = arg;
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (input.empty() || output.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Map map;
+    if (!map.loadFromFile(input)) return 1;
+
+    bool binary = format == 1 || (format == 0 && endsWith(output, ".rcmap"));
+    bool saved = binary ? map.saveToBinaryFile(output, chunkSize) : map.saveToFile(output);
+    if (!saved) return 1;
+
+    std::cout << input << " -> " << output << ": " << map.getWidth() << "x" << map.getHeight()
+              << ", " << map.getTargets().size() << " targets, " << (binary ? "binary" : "text") << std::endl;
+    return 0;
+}